@@ -0,0 +1,151 @@
+//-----------------------------------------------------------------------------
+// File: AabbBatch.h
+//
+// Desc: Overlap and sweep tests of one box against many, kept as separate
+//	   arrays of float edges. Like the blitter it has scalar reference
+//	   kernels plus SSE2 and AVX2 versions that give the same answer bit
+//	   for bit.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _AABBBATCH_H_
+#define _AABBBATCH_H_
+
+//-----------------------------------------------------------------------------
+// CAabbBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include "Blitter.h"
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Axis aligned box, edges included
+struct SAabb
+{
+	float	fMinX;
+	float	fMinY;
+	float	fMaxX;
+	float	fMaxY;
+};
+
+// The overlap every kernel agrees with: boxes sharing an edge or a corner
+// overlap, a box with a NaN edge overlaps nothing.
+inline bool Overlaps(const SAabb& a, const SAabb& b)
+{
+	return a.fMinX <= b.fMaxX && b.fMinX <= a.fMaxX && a.fMinY <= b.fMaxY && b.fMinY <= a.fMaxY;
+}
+
+// When box, moving by (d, the step's motion) from where it is, overlaps
+// fixed along one axis: the fractions of the step from lo to hi. Without
+// motion the answer is always or never.
+inline void SweepAxis(float fixedMin, float fixedMax, float boxMin, float boxMax, float d, float& lo, float& hi)
+{
+	if (d == 0.0f)
+	{
+		bool bOverlap = fixedMin <= boxMax && boxMin <= fixedMax;
+		lo = bOverlap ? -INFINITY : INFINITY;
+		hi = bOverlap ? INFINITY : -INFINITY;
+		return;
+	}
+
+	float tA = (fixedMin - boxMax) / d;
+	float tB = (fixedMax - boxMin) / d;
+	lo = tA < tB ? tA : tB;
+	hi = tA > tB ? tA : tB;
+}
+
+// The sweep every kernel agrees with: whether box, moving by (dx, dy) over
+// the step, overlaps fixed at some time of it, from tEnter to tExit in
+// fractions of the step. Either may lie outside 0 to 1. The comparisons
+// are written the way SSE min, max and cmple work, NaN included.
+inline bool SweepTimes(const SAabb& fixed, const SAabb& box, float dx, float dy, float& tEnter, float& tExit)
+{
+	float loX, hiX, loY, hiY;
+	SweepAxis(fixed.fMinX, fixed.fMaxX, box.fMinX, box.fMaxX, dx, loX, hiX);
+	SweepAxis(fixed.fMinY, fixed.fMaxY, box.fMinY, box.fMaxY, dy, loY, hiY);
+
+	tEnter	= loX > loY ? loX : loY;
+	tExit	= hiX < hiY ? hiX : hiY;
+	return tEnter <= tExit && tEnter <= 1.0f && 0.0f <= tExit;
+}
+
+// All the ground the box covers while moving by (dx, dy)
+inline SAabb SweptBounds(const SAabb& box, float dx, float dy)
+{
+	SAabb bounds = { box.fMinX + (dx < 0.0f ? dx : 0.0f), box.fMinY + (dy < 0.0f ? dy : 0.0f),
+					 box.fMaxX + (dx > 0.0f ? dx : 0.0f), box.fMaxY + (dy > 0.0f ? dy : 0.0f) };
+	return bounds;
+}
+
+// Many boxes, edge i of box i in each array
+struct SAabbArrays
+{
+	const float*	pMinX;
+	const float*	pMinY;
+	const float*	pMaxX;
+	const float*	pMaxY;
+};
+
+// Sets bit i % 64 of pMask[i / 64] when box overlaps box i and clears it
+// otherwise, for the (count + 63) / 64 words. Returns how many overlap.
+typedef size_t (*AABBBATCH_OVERLAP)(const SAabb& box, const SAabbArrays& boxes, size_t count, uint64_t* pMask);
+
+// Box i moves by (pDX[i], pDY[i]) over the step. Sets its bit like the
+// overlap kernels when SweepTimes() says it meets fixed during the step,
+// and pTime[i] to the time of impact, tEnter but not before 0. pTime is
+// written for every box, it means nothing where the bit is clear.
+typedef size_t (*AABBBATCH_SWEEP)(const SAabb& fixed, const SAabbArrays& boxes, const float* pDX, const float* pDY,
+								  size_t count, float* pTime, uint64_t* pMask);
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CAabbBatch (Class)
+// Desc : Static entry points. The kernel follows the blitter's levels, the
+//		fastest one the CPU runs is picked by Init().
+//-----------------------------------------------------------------------------
+class CAabbBatch
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class
+	//-------------------------------------------------------------------------
+	static void			Init();
+	static EBlitLevel	GetLevel()		{ return m_eLevel; }
+	static bool			SetLevel(EBlitLevel eLevel);
+	static AABBBATCH_OVERLAP GetKernel(EBlitLevel eLevel);
+	static AABBBATCH_SWEEP	GetSweepKernel(EBlitLevel eLevel);
+
+	static size_t		Overlap(const SAabb& box, const SAabbArrays& boxes, size_t count, uint64_t* pMask)
+	{
+		return m_pfnOverlap(box, boxes, count, pMask);
+	}
+
+	static size_t		Sweep(const SAabb& fixed, const SAabbArrays& boxes, const float* pDX, const float* pDY,
+							  size_t count, float* pTime, uint64_t* pMask)
+	{
+		return m_pfnSweep(fixed, boxes, pDX, pDY, count, pTime, pMask);
+	}
+
+	// Checks every supported kernel against the scalar one on random boxes
+	// and motions.
+	static bool			Verify(int iterations = 2000);
+
+	// Boxes tested per microsecond by one kernel, 0 if the CPU cannot run it.
+	static double		MeasureThroughput(EBlitLevel eLevel, int iterations = 200);
+	static double		MeasureSweepThroughput(EBlitLevel eLevel, int iterations = 200);
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Static Variables for This Class
+	//-------------------------------------------------------------------------
+	static EBlitLevel			m_eLevel;
+	static AABBBATCH_OVERLAP	m_pfnOverlap;
+	static AABBBATCH_SWEEP		m_pfnSweep;
+};
+
+#endif // _AABBBATCH_H_
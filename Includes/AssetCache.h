@@ -0,0 +1,177 @@
+//-----------------------------------------------------------------------------
+// File: AssetCache.h
+//
+// Desc: Shared, reference counted cache of decoded sprite images. Every
+//	   image file is decoded once into a 32-bit surface and then shared by
+//	   all the sprites that use it.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _ASSETCACHE_H_
+#define _ASSETCACHE_H_
+
+//-----------------------------------------------------------------------------
+// CAssetCache Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include "RleImage.h"
+#include "HitMask.h"
+#include "Filters.h"
+#include "TextureAtlas.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+struct SSpriteFrame
+{
+	std::string	strName;	// "<file stem>_<index>", also its atlas table name
+	SAtlasRect	rc;			// Position inside the asset image
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpriteAsset (Class)
+// Desc : One decoded image. Sprites hold a pointer to it as a handle and keep
+//		their own position, velocity and scale.
+//-----------------------------------------------------------------------------
+class CSpriteAsset
+{
+	friend class CAssetCache;
+
+public:
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	const std::string&	Path() const	 { return m_strPath; }
+	int					Width() const	 { return m_Image.Width(); }
+	int					Height() const	 { return m_Image.Height(); }
+	int					RefCount() const { return m_iRefCount; }
+	uint32_t			GetId() const	 { return m_nId; }		// Unique per asset, used as a sort key
+
+	CFrameBuffer&		Image()			 { return m_Image; }
+	const CFrameBuffer&	Image() const	 { return m_Image; }
+
+	// Transparency is baked into the alpha channel once per asset:
+	// 0xFF marks an opaque pixel, 0x00 a transparent one.
+	bool				HasMask() const	 { return m_bMasked; }
+	void				BuildColorKeyMask(uint32_t keyColor);
+	void				BuildMask(const CSpriteAsset* pMask);
+
+	// Opaque runs of the masked image, valid once a mask has been built.
+	const CRleImage&	Spans() const	 { return m_Spans; }
+
+	// The same pixels as bits, for collisions. Built with the spans.
+	const CHitMask&		HitMask() const	 { return m_HitMask; }
+
+	// Named animation frames laid out as a grid inside the image.
+	void				DefineFrameGrid(int x, int y, int w, int h, int count, int columns);
+	int					GetFrameCount() const	 { return (int)m_Frames.size(); }
+	const SSpriteFrame&	GetFrame(int i) const	 { return m_Frames[i]; }
+	int					FindFrame(const std::string& strName) const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class (only the cache creates them)
+	//-------------------------------------------------------------------------
+			 CSpriteAsset(const std::string& strPath);
+	virtual ~CSpriteAsset();
+
+	CSpriteAsset(const CSpriteAsset& rhs);
+	CSpriteAsset& operator=(const CSpriteAsset& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+	bool				Load();
+	bool				AllocImage(int width, int height);
+	bool				BuildScaled(const CSpriteAsset* pBase, int width, int height, CGenericFilter* pFilter);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::string			m_strPath;
+	uint32_t			m_nId;
+	CFrameBuffer		m_Image;
+	int					m_iRefCount;
+	bool				m_bMasked;
+	uint32_t			m_KeyColor;		// Key the mask was built from (0x00RRGGBB)
+	CRleImage			m_Spans;
+	CHitMask			m_HitMask;
+	std::vector<SSpriteFrame> m_Frames;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CAssetCache (Class)
+// Desc : Loads images on first use and hands out shared CSpriteAsset handles.
+//		Assets whose reference count drops to zero stay resident so that
+//		short lived objects (bullets) never go back to disk. Call Purge()
+//		to free them. Scaled variants of an image are cached the same way,
+//		keyed by the image and the scale.
+//-----------------------------------------------------------------------------
+class CAssetCache
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CAssetCache();
+	virtual ~CAssetCache();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	CSpriteAsset*	Acquire(const char* szFileName);
+#ifdef _WIN32
+	CSpriteAsset*	Acquire(int resourceID);
+#endif
+	CSpriteAsset*	AcquireScaled(const CSpriteAsset* pBase, float scaleX, float scaleY);
+	void			Release(CSpriteAsset* pAsset);
+	bool			Preload(const char* szFileName);
+	void			Purge();
+	void			LogStats() const;
+
+	// Moves every resident image into shared atlas pages. Assets created
+	// later keep their own memory until the next call.
+	bool			BuildAtlas();
+	bool			IsAtlasDirty() const	{ return m_bAtlasDirty; }
+	const CTextureAtlas& GetAtlas() const	{ return m_Atlas; }
+
+	// The cache does not lock by itself. When sprites are created on one
+	// thread and the atlas is rebuilt on another, both hold this lock.
+	std::mutex&		GetLock()				{ return m_Lock; }
+
+	// Filter used to build scaled variants from now on (not owned).
+	void			SetScaleFilter(CGenericFilter* pFilter);
+	CGenericFilter*	GetScaleFilter() const { return m_pScaleFilter; }
+
+	unsigned long	GetHitCount() const	 { return m_nHits; }
+	unsigned long	GetMissCount() const { return m_nMisses; }
+	size_t			GetAssetCount() const { return m_Assets.size(); }
+
+private:
+	CAssetCache(const CAssetCache& rhs);
+	CAssetCache& operator=(const CAssetCache& rhs);
+
+	static std::string	MakeKey(const char* szFileName);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::map<std::string, CSpriteAsset*>	m_Assets;
+	unsigned long							m_nHits;
+	unsigned long							m_nMisses;
+	CGenericFilter*							m_pScaleFilter;
+	CTextureAtlas							m_Atlas;
+	bool									m_bAtlasDirty;
+	std::mutex								m_Lock;
+};
+
+extern CAssetCache g_AssetCache;
+
+#endif // _ASSETCACHE_H_
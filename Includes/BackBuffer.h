@@ -3,19 +3,35 @@
 // August 24, 2004.
 #ifndef BACKBUFFER_H
 #define BACKBUFFER_H
+#ifdef _WIN32
 #include "main.h"
+#endif
+#include "FrameBuffer.h"
+#include "DirtyRegion.h"
 
 class BackBuffer
 {
 public:
+#ifdef _WIN32
 	BackBuffer(HWND hWnd, int width, int height);
+#endif
+	// Headless back buffer, no window and no GDI objects.
+	BackBuffer(int width, int height);
 	~BackBuffer();
 
 	void present();
+	// Copies only the changed rectangles to the window.
+	void present(const CDirtyRegion& region);
 	void reset();
+	void flush() const;
 
+#ifdef _WIN32
 	HDC getDC() const { return mhDC; }
 	HWND getHWND() const { return mhWnd; }
+#endif
+
+	// Like getDC(), a const back buffer can still be drawn into.
+	CFrameBuffer& getFrameBuffer() const { return mFrameBuffer; }
 
 	int width() const { return mWidth; }
 	int height() const { return mHeight; }
@@ -32,11 +48,14 @@ private:
 	BackBuffer& operator=(const BackBuffer& rhs);
 
 private:
+#ifdef _WIN32
 	HWND mhWnd;
 	HDC mhDC;
 	HBITMAP mhSurface;
 	HBITMAP mhOldObject;
+#endif
+	mutable CFrameBuffer mFrameBuffer;
 	int mWidth;
 	int mHeight;
 };
-#endif // BACKBUFFER_H
\ No newline at end of file
+#endif // BACKBUFFER_H
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// File: Blitter.h
+//
+// Desc: Software blitter for CFrameBuffer surfaces. Every row operation has a
+//	   scalar reference kernel plus SSE2 and AVX2 versions; the fastest one the
+//	   CPU supports is picked once at startup.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _BLITTER_H_
+#define _BLITTER_H_
+
+//-----------------------------------------------------------------------------
+// CBlitter Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include "RleImage.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+enum EBlitMode
+{
+	BLIT_OPAQUE,		// Plain copy
+	BLIT_COLORKEY,		// Copy every pixel whose RGB differs from the key
+	BLIT_ALPHA,			// Blend using the 8-bit source alpha
+	BLIT_MODE_COUNT
+};
+
+enum EBlitLevel
+{
+	BLIT_SCALAR,
+	BLIT_SSE2,
+	BLIT_AVX2,
+	BLIT_LEVEL_COUNT
+};
+
+// Row kernels, count pixels from pSrc to pDst.
+typedef void (*BLITROW_COPY)(uint32_t* pDst, const uint32_t* pSrc, int count);
+typedef void (*BLITROW_KEY)(uint32_t* pDst, const uint32_t* pSrc, int count, uint32_t key);
+typedef void (*BLITROW_ALPHA)(uint32_t* pDst, const uint32_t* pSrc, int count);
+
+struct SBlitKernels
+{
+	const char*		szName;
+	BLITROW_COPY	pfnCopy;
+	BLITROW_KEY		pfnColorKey;
+	BLITROW_ALPHA	pfnAlpha;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBlitter (Class)
+// Desc : Static blit entry points. Rectangles are clipped against the
+//		destination; the source rectangle is assumed to be inside the source.
+//-----------------------------------------------------------------------------
+class CBlitter
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Static Functions for This Class
+	//-------------------------------------------------------------------------
+	static void			Init();
+	static EBlitLevel	GetMaxLevel();
+	static EBlitLevel	GetLevel()		{ return m_eLevel; }
+	static bool			SetLevel(EBlitLevel eLevel);
+	static const SBlitKernels& GetKernels(EBlitLevel eLevel);
+
+	static void			Blit(CFrameBuffer& dst, int dx, int dy,
+							 const CFrameBuffer& src, int sx, int sy, int w, int h,
+							 EBlitMode eMode, uint32_t key = 0);
+	static void			BlitStretched(CFrameBuffer& dst, int dx, int dy, int dw, int dh,
+									  const CFrameBuffer& src, int sx, int sy, int sw, int sh,
+									  EBlitMode eMode, uint32_t key = 0);
+
+	// Copies only the opaque runs of a masked image. The spans must have
+	// been built from src; use it for binary masks (alpha 0x00 / 0xFF).
+	static void			BlitSpans(CFrameBuffer& dst, int dx, int dy,
+								  const CFrameBuffer& src, const CRleImage& spans,
+								  int sx, int sy, int w, int h);
+
+	// Runs one row of the given mode with the current kernels.
+	static void			BlitRow(uint32_t* pDst, const uint32_t* pSrc, int count, EBlitMode eMode, uint32_t key)
+	{
+		switch (eMode)
+		{
+		case BLIT_OPAQUE:	m_Kernels.pfnCopy(pDst, pSrc, count); break;
+		case BLIT_COLORKEY:	m_Kernels.pfnColorKey(pDst, pSrc, count, key); break;
+		default:			m_Kernels.pfnAlpha(pDst, pSrc, count); break;
+		}
+	}
+
+	// Checks every supported kernel is bit-identical to the scalar one.
+	static bool			Verify();
+
+	// Throughput of one kernel in megapixels per second.
+	static double		MeasureThroughput(EBlitLevel eLevel, EBlitMode eMode, int iterations = 200);
+
+	// How many times faster BlitSpans draws an image than the alpha kernel.
+	static double		MeasureSpanSpeedup(const CFrameBuffer& src, const CRleImage& spans, int iterations = 2000);
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Static Variables for This Class
+	//-------------------------------------------------------------------------
+	static EBlitLevel	m_eLevel;
+	static SBlitKernels	m_Kernels;
+};
+
+#endif // _BLITTER_H_
@@ -18,19 +18,18 @@ public:
 		return (min + max) / 2;
 	}
 
-	bool Contains(Vec2& point)
+	bool Contains(const Vec2& point)
 	{
 		if ((point.x >= min.x && point.x <= max.x) && (point.y >= min.y && point.y <= max.y))
 			return true;
 		return false;
 	}
 
+	// Overlap on both axes, edges included. Also true for boxes crossing
+	// each other with no corner inside the other.
 	bool Intersects(CBoundingBox& box)
 	{
-		if (Contains(box.min) || Contains(box.max) || Contains(Vec2(box.min.x, box.max.y)) || Contains(Vec2(box.max.x, box.min.y))
-			|| box.Contains(min) || box.Contains(max))
-			return true;
-		return false;
+		return min.x <= box.max.x && box.min.x <= max.x && min.y <= box.max.y && box.min.y <= max.y;
 	}
 };
 
@@ -1,21 +1,20 @@
 #pragma once
 
-#include "Main.h"
+#include "Common.h"
 #include "Sprite.h"
 #include "CBoundingBox.inl"
 
 class CBullet {
 public:
 	CBullet();
-	CBullet(const BackBuffer* pBackBuffer);
-	CBullet(const BackBuffer* pBackBuffer, Vec2);
+	CBullet(Vec2);
 	virtual ~CBullet();
 	virtual int GetType() { return 0; }
 
-	void Draw();
+	void Draw(CDrawList& drawList);
 	void Tick(float);
 	void SetPosition(float, float);
-	bool IsOutside();
+	bool IsOutside(int width, int height);
 	bool Intersects(Sprite*);
 
 	Sprite* m_pSprite;
@@ -25,12 +24,12 @@ public:
 
 class CChickenBullet : public CBullet {
 public:
-	CChickenBullet(const BackBuffer* pBackBuffer, Vec2);
+	CChickenBullet(Vec2);
 	int GetType() override { return 1; }
 };
 
 class BigBossBullet : public CBullet {
 public:
-	BigBossBullet(const BackBuffer* pBackBuffer, Vec2);
+	BigBossBullet(Vec2);
 	int GetType() override { return 1; }
 };
\ No newline at end of file
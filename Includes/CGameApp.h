@@ -14,13 +14,18 @@
 //-----------------------------------------------------------------------------
 #include "Main.h"
 #include "CTimer.h"
-#include "CPlayer.h"
+#include "GameWorld.h"
 #include "BackBuffer.h"
 #include "ImageFile.h"
-#include "CChicken.h"
 #include <vector>
-#include "CHealth.h"
-#include "BigBoss.h"
+#include "DrawList.h"
+#include "ScrollingBackground.h"
+#include "TripleBuffer.h"
+#include "WorldSnapshot.h"
+#include "FixedTimestep.h"
+#include "Replay.h"
+#include <atomic>
+#include <thread>
 
 //-----------------------------------------------------------------------------
 // Forward Declarations
@@ -50,7 +55,10 @@ public:
 	bool		InitInstance( LPCTSTR lpCmdLine, int iCmdShow );
 	int		 BeginGame( );
 	bool		ShutDown( );
-	void	 GetWindowSize(int& width, int& height);
+
+	// Plays a recorded session back without a window and reports whether
+	// the world still steps the same. Returns the process exit code.
+	static int	RunReplay( LPCTSTR lpFileName );
 	
 private:
 	//-------------------------------------------------------------------------
@@ -61,10 +69,20 @@ private:
 	void		FrameAdvance	  ( );
 	bool		CreateDisplay	 ( );
 	void		ChangeDevice	  ( );
-	void		SetupGameState	( );
 	void		AnimateObjects	( );
-	void		DrawObjects	   ( );
+	void		DrawObjects	   ( const SWorldSnapshot& snapshot );
+	void		LogTileScaling	( );
+	void		LogBulletUpdate	( );
+	void		LogBroadphase	( );
+	void		LogSpriteDraws	( );
 	void		ProcessInput	  ( );
+	void		PlaySounds		( unsigned int nSounds );
+
+	void		StartSimulation	( );
+	void		StopSimulation	( );
+	void		SimulationMain	( );
+	void		RecordPrevious	( );
+	void		RecordSnapshot	( double fTime );
 	
 	//-------------------------------------------------------------------------
 	// Private Static Functions For This Class
@@ -91,21 +109,39 @@ private:
 	POINT				   m_OldCursorPos;	 // Old cursor position for tracking
 	HINSTANCE				m_hInstance;
 
-	CImageFile				m_imgBackground;
-	float					m_fBackgroundOffset;
+	CSpriteAsset*			m_pBackground;
+	CScrollingBackground	m_Background;
+	int						m_iBackgroundRow;	// Scroll row the back buffer shows
 
 	BackBuffer*				m_pBBuffer;
-	CPlayer*				m_pPlayer;
-	CPlayer*				m_pPlane;
-	std::vector<CBullet*>	m_bullets;
-	std::vector<CHealth*>   m_pHealth;
-	std::vector<CChicken*>  m_pChicken;
-	std::vector<BigBoss*>  m_pBigBoss;
-
-	int m_iScore;
+	CDrawList				m_DrawList;		// Sprite draws of the current frame
+	CFrameArena				m_FrameArena;	// Scratch memory, reset after each frame
+	CDirtyRegion			m_DirtyRegion;	// What changed since the last present
+	CWorkerPool				m_RenderPool;	// Draws screen tiles on full redraws
+	bool					m_bFullRedraw;	// Window uncovered / resized, redraw it all
+
 	int m_iLastScore;
-	int m_iKilledChickens;
-	int m_iLevel;
+
+	// Simulation thread. It owns the world once started and hands the
+	// renderer a snapshot of each step.
+	CGameWorld						m_World;
+	std::thread						m_SimThread;
+	CFixedTimestep					m_SimClock;
+	CDrawList						m_SimDrawList;		// Records the snapshots
+	std::vector<SDrawCommand>		m_PrevCommands;		// Before the last step, by object id
+	CTripleBuffer<SWorldSnapshot>	m_Snapshots;
+	std::atomic<bool>				m_bSimQuit;
+	std::atomic<bool>				m_bGameOver;
+	CReplayWriter					m_Recorder;			// Every step's input, to REPLAY_SESSION_FILE
+
+	// Input from the message loop, taken by the next step
+	std::atomic<unsigned long>		m_nInputDirection;
+	std::atomic<int>				m_nFireRequests;
+	std::atomic<int>				m_iFieldWidth;		// Client area, the world's play field
+	std::atomic<int>				m_iFieldHeight;
+
+	// CPlayer::ESounds raised by steps the render thread has not played yet
+	std::atomic<unsigned int>		m_nPendingSounds;
 };
 
 #endif // _CGAMEAPP_H_
\ No newline at end of file
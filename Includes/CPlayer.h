@@ -13,10 +13,24 @@
 //-----------------------------------------------------------------------------
 // CPlayer Specific Includes
 //-----------------------------------------------------------------------------
-#include "Main.h"
+#include "Common.h"
 #include "Sprite.h"
-#include "CBullet.h"
-#include "CHealth.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// What the world's steps change in a player, saved with the world
+struct SPlayerState
+{
+	double		fX, fY;				// Position and velocity of the plane
+	double		fVelX, fVelY;
+	double		fExplosionX, fExplosionY;
+	float		fTimer;
+	int			iSpeedState;		// CPlayer::ESpeedStates
+	int			iLives;
+	int			iExplosionFrame;
+	int			bExplosion;
+};
 
 //-----------------------------------------------------------------------------
 // Main Class Definitions
@@ -45,36 +59,51 @@ public:
 		SPEED_STOP
 	};
 
+	// Sounds the player asked for, collected by TakeSounds()
+	enum ESounds
+	{
+		SOUND_JET_START	= 1,
+		SOUND_JET_STOP	= 2,
+		SOUND_JET_CABIN	= 4,
+		SOUND_EXPLOSION	= 8,
+	};
+
 	//-------------------------------------------------------------------------
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
-			 CPlayer(const BackBuffer *pBackBuffer);
+			 CPlayer();
 	virtual ~CPlayer();
 
 	//-------------------------------------------------------------------------
 	// Public Functions for This Class.
 	//-------------------------------------------------------------------------
 	void					Update( float dt );
-	void					Draw();
-	void					Move(ULONG ulDirection);
+	void					Draw(CDrawList& drawList);
+	void					Move(unsigned long ulDirection, int width, int height);
 	Vec2&					Position();
 	Vec2&					Velocity();
 	Vec2                    Size();
 
-	void					Init(const BackBuffer* pBackBuffer);
+	void					Init();
 	void                    Intersects(CPlayer*);
-	bool                    Intersects(Sprite*);
-	bool                    IntersectsBoss(Sprite*);
+	// Whether the pixels of mask, drawn with its upper-left at (x, y),
+	// touch the plane's
+	bool                    Intersects(const CHitMask& mask, int x, int y);
+	SAtlasRect              GetHitRect();			// Where the plane is drawn
+	const CHitMask*         GetHitMask();			// Of the image drawn there, if any
 
 
 	void					Explode();
 	bool					AdvanceExplosion();
-	CBullet*				CreateBullet(BackBuffer*);
 
 	bool                    IsExploding();
 
 	int						GetLives();
 	void					AddLife();
+	unsigned int			TakeSounds();
+
+	void					GetState(SPlayerState& state) const;
+	void					SetState(const SPlayerState& state);
 
 private:
 	//-------------------------------------------------------------------------
@@ -84,6 +113,7 @@ private:
 	Sprite*					m_pLifeImages[3];
 	ESpeedStates			m_eSpeedState;
 	float					m_fTimer;
+	unsigned int			m_nSounds;		// ESounds since the last TakeSounds()
 	
 	bool					m_bExplosion;
 	AnimatedSprite*			m_pExplosionSprite;
@@ -0,0 +1,28 @@
+//-----------------------------------------------------------------------------
+// File: Common.h
+//
+// Desc: Defines and helpers shared by the whole game. Includes no platform
+//	   headers, so the game world builds anywhere.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _COMMON_H_
+#define _COMMON_H_
+
+//-----------------------------------------------------------------------------
+// Common Includes
+//-----------------------------------------------------------------------------
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Common defines
+//-----------------------------------------------------------------------------
+#define EPS 1e-3 // epsilon (the smallest float value used)
+#define PI 3.14159265358979323846
+#define DEG2RAD(deg) (PI * (deg) / 180.0)
+#define RAD2DEG(rad) ((rad) * 180.0 / PI)
+
+#endif // _COMMON_H_
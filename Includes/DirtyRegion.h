@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------------
+// File: DirtyRegion.h
+//
+// Desc: Tracks which parts of the screen changed this frame as a small set
+//	   of non-overlapping rectangles, so only those are cleared, redrawn and
+//	   presented.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _DIRTYREGION_H_
+#define _DIRTYREGION_H_
+
+//-----------------------------------------------------------------------------
+// CDirtyRegion Specific Includes
+//-----------------------------------------------------------------------------
+#include "TextureAtlas.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const float DIRTY_FULL_THRESHOLD = 0.5f;	// Coverage above which a full redraw is cheaper
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CDirtyRegion (Class)
+// Desc : Rectangles are clipped to the screen and merged with any rectangle
+//		they overlap or touch, so the set never overlaps. Once the covered
+//		area passes the threshold the region reports itself as full.
+//-----------------------------------------------------------------------------
+class CDirtyRegion
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CDirtyRegion();
+	virtual ~CDirtyRegion();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Begin(int width, int height);
+	void			Add(int x, int y, int w, int h);
+	void			Add(const SAtlasRect& rc)	{ Add(rc.x, rc.y, rc.w, rc.h); }
+	void			MarkAll()					{ m_bFull = true; }
+
+	bool			IsEmpty() const				{ return !m_bFull && m_Rects.empty(); }
+	bool			IsFull() const;
+	float			GetCoverage() const;
+
+	const std::vector<SAtlasRect>& GetRects() const { return m_Rects; }
+
+	void			SetFullThreshold(float fThreshold)	{ m_fThreshold = fThreshold; }
+	float			GetFullThreshold() const			{ return m_fThreshold; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<SAtlasRect>	m_Rects;
+	int						m_iWidth;
+	int						m_iHeight;
+	size_t					m_nArea;		// Sum of the rectangle areas
+	float					m_fThreshold;
+	bool					m_bFull;
+};
+
+#endif // _DIRTYREGION_H_
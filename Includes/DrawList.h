@@ -0,0 +1,147 @@
+//-----------------------------------------------------------------------------
+// File: DrawList.h
+//
+// Desc: Per frame list of sprite draw commands. Objects record what they
+//	   want drawn, the list radix sorts the commands by layer and image and
+//	   then draws each run of the same image as one batch, or bins them into
+//	   screen tiles that worker threads draw side by side.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _DRAWLIST_H_
+#define _DRAWLIST_H_
+
+//-----------------------------------------------------------------------------
+// CDrawList Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include "DirtyRegion.h"
+#include "WorkerPool.h"
+#include <vector>
+
+class CSpriteAsset;
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Back to front. Within a layer the draw order of different images is not
+// kept, the same image keeps its submission order.
+enum EDrawLayer
+{
+	DRAWLAYER_PLAYER,
+	DRAWLAYER_BULLETS,
+	DRAWLAYER_ENEMIES,
+	DRAWLAYER_PICKUPS,
+	DRAWLAYER_BOSS,
+	DRAWLAYER_HUD,
+	DRAWLAYER_COUNT
+};
+
+const int DRAW_TILE_SIZE = 64;		// Tiles are square, in pixels
+
+struct SDrawCommand
+{
+	EDrawLayer			eLayer;
+	const CSpriteAsset*	pAsset;
+	int					x, y;			// Upper-left corner on screen
+	float				fScaleX;		// Stretch still to apply (1 when the
+	float				fScaleY;		// asset is a pre-scaled variant)
+	int					iFrame;			// Named frame of the asset, -1 for all of it
+	uint32_t			nObject;		// Id of the object that recorded it, 0 for none
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CDrawList (Class)
+// Desc : Call Begin() each frame, Add() once per sprite, then Submit(). For
+//		partial redraws, CollectDirty() marks what changed since the last
+//		frame and Submit() is called once per dirty rectangle.
+//-----------------------------------------------------------------------------
+class CDrawList
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CDrawList();
+	virtual ~CDrawList();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Begin();
+	void			Add(EDrawLayer eLayer, const CSpriteAsset* pAsset, int x, int y,
+						float fScaleX = 1.0f, float fScaleY = 1.0f, int iFrame = -1,
+						uint32_t nObject = 0);
+	void			Add(const SDrawCommand& cmd);
+	void			Submit(CFrameBuffer& target, int originX = 0, int originY = 0);
+
+	// Same result as Submit(), pixel for pixel. Each command goes into the
+	// bin of every tile it overlaps, in draw order, and the pool draws the
+	// tiles in parallel. A tile only ever sees its own pixels, so the
+	// order of the draws on any pixel is the one Submit() uses.
+	void			SubmitParallel(CFrameBuffer& target, CWorkerPool& pool, int originX = 0, int originY = 0);
+
+	// Adds the old and new bounds of every sprite that appeared, moved,
+	// changed or went away since the previous call. Call once per frame.
+	void			CollectDirty(CDirtyRegion& region);
+
+	// What was recorded, in recording order. A frame can be handed to
+	// another thread as a copy of this and replayed there with Add().
+	const std::vector<SDrawCommand>& GetCommands() const { return m_Commands; }
+
+	// Counters of the current frame, summed over every Submit()
+	unsigned int	GetDrawCount() const	{ return m_nDraws; }
+	unsigned int	GetBatchCount() const	{ return m_nBatches; }
+
+	// Times SubmitParallel() of the recorded commands into a width x height
+	// buffer with 1 to maxThreads threads, and checks every result against
+	// Submit(). msPerFrame[i] is the time with i + 1 threads.
+	bool			MeasureTileScaling(int width, int height, int maxThreads, int iterations,
+									   std::vector<double>& msPerFrame);
+
+private:
+	CDrawList(const CDrawList& rhs);
+	CDrawList& operator=(const CDrawList& rhs);
+
+	struct SSortItem
+	{
+		uint32_t	key;		// Layer in the top 8 bits, asset id below
+		uint32_t	index;		// Into m_Commands
+	};
+
+	struct SDrawSignature
+	{
+		const CSpriteAsset*	pAsset;
+		int					iFrame;
+		SAtlasRect			rcBounds;
+
+		bool operator<(const SDrawSignature& rhs) const;
+	};
+
+	void			Sort();
+	void			BinTiles(int width, int height, int originX, int originY);
+	static bool		DrawCommand(CFrameBuffer& target, const SDrawCommand& cmd, int originX, int originY);
+	static SAtlasRect GetBounds(const SDrawCommand& cmd, SAtlasRect* pSource = NULL);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<SDrawCommand>	m_Commands;
+	std::vector<SSortItem>		m_Items;
+	std::vector<SSortItem>		m_Scratch;
+	std::vector<SDrawSignature>	m_Current;
+	std::vector<SDrawSignature>	m_Previous;		// What is on screen now
+	std::vector<uint32_t>		m_TileStart;	// Bin of tile t is [start[t], start[t + 1])
+	std::vector<uint32_t>		m_TileItems;	// Command indices, bin after bin
+	std::vector<uint32_t>		m_TileFill;
+	int							m_nTilesX;
+	int							m_nTilesY;
+	bool						m_bSorted;
+	unsigned int				m_nDraws;
+	unsigned int				m_nBatches;
+};
+
+#endif // _DRAWLIST_H_
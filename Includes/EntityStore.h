@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.h
+//
+// Desc: Structure of arrays storage for one kind of entity (bullets,
+//	   chickens, pickups, bosses). Each component is its own contiguous
+//	   array, so a pass over the positions reads nothing else.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _ENTITYSTORE_H_
+#define _ENTITYSTORE_H_
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "SlotMap.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CEntityStore (Class)
+// Desc : Entity i is element i of every array. Removing one moves the last
+//		entity into its place, so the arrays stay dense and the order of
+//		the entities is not kept. Pointers from PosX() and friends stay
+//		valid across Remove(), not across Add(). Indices change, so an
+//		entity is kept track of by its handle, which Find() turns into
+//		its current index, or SLOT_NONE once the entity is gone.
+//		With a capacity set the store is a fixed pool: all memory is
+//		taken up front, freed slots are recycled and Add() fails once
+//		it is full.
+//-----------------------------------------------------------------------------
+class CEntityStore
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CEntityStore();
+	virtual ~CEntityStore();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Position is the center, velocity is in pixels per step. nArt indexes
+	// the owner's table of images, nObject tags the entity's draws. Returns
+	// the null handle when the store is at its capacity.
+	SSlotHandle		Add(float x, float y, float vx, float vy, float scale, uint16_t nArt, uint32_t nObject);
+	void			Remove(size_t index);
+	bool			Remove(SSlotHandle handle);
+	void			Clear();
+	void			Reserve(size_t count);
+
+	// 0 (the default) lets the store grow
+	void			SetCapacity(size_t count);
+	size_t			GetCapacity() const	{ return m_nCapacity; }
+
+	// Most entities alive at once, and Add() calls refused for lack of room
+	size_t			GetPeak() const				{ return m_nPeak; }
+	unsigned long	GetExhaustedCount() const	{ return m_nExhausted; }
+	void			ResetStats()				{ m_nPeak = Size(); m_nExhausted = 0; }
+
+	// Adds every velocity to its position
+	void			Move();
+
+	size_t			Find(SSlotHandle handle) const		{ return m_Slots.Find(handle); }
+	SSlotHandle		GetHandle(size_t index) const		{ return m_Slots.GetHandle(index); }
+
+	size_t			Size() const		{ return m_PosX.size(); }
+	bool			IsEmpty() const		{ return m_PosX.empty(); }
+
+	float*			PosX()				{ return m_PosX.data(); }
+	float*			PosY()				{ return m_PosY.data(); }
+	float*			VelX()				{ return m_VelX.data(); }
+	float*			VelY()				{ return m_VelY.data(); }
+	float*			Scale()				{ return m_Scale.data(); }
+	const float*	PosX() const		{ return m_PosX.data(); }
+	const float*	PosY() const		{ return m_PosY.data(); }
+	const float*	VelX() const		{ return m_VelX.data(); }
+	const float*	VelY() const		{ return m_VelY.data(); }
+	const float*	Scale() const		{ return m_Scale.data(); }
+	const uint16_t*	Art() const			{ return m_Art.data(); }
+	const uint32_t*	Object() const		{ return m_Object.data(); }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<float>		m_PosX;
+	std::vector<float>		m_PosY;
+	std::vector<float>		m_VelX;
+	std::vector<float>		m_VelY;
+	std::vector<float>		m_Scale;
+	std::vector<uint16_t>	m_Art;
+	std::vector<uint32_t>	m_Object;
+	CSlotMap				m_Slots;
+	size_t					m_nCapacity;
+	size_t					m_nPeak;
+	unsigned long			m_nExhausted;
+};
+
+#endif // _ENTITYSTORE_H_
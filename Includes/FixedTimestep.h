@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// File: FixedTimestep.h
+//
+// Desc: Turns variable frame times into a whole number of fixed simulation
+//	   steps, so game speed does not depend on the frame rate.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FIXEDTIMESTEP_H_
+#define _FIXEDTIMESTEP_H_
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Entities move a constant amount per step, tuned when the game ran one
+// step per (uncapped) frame. 240 steps a second keeps that feel.
+const double SIM_TIMESTEP	= 1.0 / 240.0;		// Seconds per step
+const int	 SIM_MAX_STEPS	= 15;				// Catch-up steps per Advance() (62.5 ms)
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFixedTimestep (Class)
+// Desc : Accumulates real time and hands it out in fixed steps. When more
+//		than the step cap is owed (a stall, a breakpoint, a machine that
+//		cannot keep up) the rest is dropped and the game slows down for a
+//		moment, instead of spending ever longer catching up.
+//-----------------------------------------------------------------------------
+class CFixedTimestep
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFixedTimestep();
+	virtual ~CFixedTimestep();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Reset();
+
+	// Adds elapsed seconds and returns how many steps to run now, 0 to the
+	// step cap.
+	int				Advance(double fTimeElapsed);
+
+	// Time owed that is less than a step, as a fraction of a step. The
+	// latest state is this far behind real time.
+	double			GetRemainder() const	{ return m_fAccumulator; }
+	float			GetAlpha() const		{ return (float)(m_fAccumulator / m_fStep); }
+
+	void			SetStep(double fStep)	{ m_fStep = fStep; }
+	double			GetStep() const			{ return m_fStep; }
+	void			SetMaxSteps(int nSteps)	{ m_nMaxSteps = nSteps; }
+	int				GetMaxSteps() const		{ return m_nMaxSteps; }
+
+	unsigned long	GetStepCount() const	{ return m_nSteps; }
+	double			GetDroppedTime() const	{ return m_fDropped; }
+
+	// Seconds on a monotonic clock, the same on every thread
+	static double	Now();
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	double			m_fStep;
+	double			m_fAccumulator;
+	double			m_fDropped;		// Total time given up to the step cap
+	int				m_nMaxSteps;
+	unsigned long	m_nSteps;		// Total steps handed out
+};
+
+#endif // _FIXEDTIMESTEP_H_
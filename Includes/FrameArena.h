@@ -0,0 +1,116 @@
+//-----------------------------------------------------------------------------
+// File: FrameArena.h
+//
+// Desc: Linear (bump) allocator for data that only lives for one frame or
+//	   one step, and an allocator adapter so standard containers can use it.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FRAMEARENA_H_
+#define _FRAMEARENA_H_
+
+//-----------------------------------------------------------------------------
+// CFrameArena Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const size_t	FRAMEARENA_DEFAULT_SIZE	= 64 * 1024;
+const uint8_t	FRAMEARENA_POISON		= 0xDD;		// Debug fill of reset memory
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFrameArena (Class)
+// Desc : Allocate() hands out the next bytes of one block and Reset()
+//		takes them all back at once; nothing is freed on its own. When a
+//		frame needs more than the block, the rest comes from extra blocks
+//		and the next Reset() replaces the block with one the size of the
+//		peak, so a steady game loop stops touching the heap. Debug builds
+//		fill reset memory with FRAMEARENA_POISON, so anything still
+//		pointing into the last frame reads garbage rather than stale data.
+//		One thread at a time.
+//-----------------------------------------------------------------------------
+class CFrameArena
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFrameArena(size_t capacity = FRAMEARENA_DEFAULT_SIZE);
+	virtual ~CFrameArena();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void*			Allocate(size_t size, size_t alignment = sizeof(void*));
+	void			Reset();
+
+	size_t			GetUsed() const			{ return m_nUsed; }
+	size_t			GetPeak() const			{ return m_nPeak; }		// Most bytes used by one frame
+	size_t			GetCapacity() const		{ return m_nCapacity; }
+	unsigned long	GetOverflowCount() const { return m_nOverflows; }	// Extra blocks ever taken
+
+private:
+	CFrameArena(const CFrameArena& rhs);
+	CFrameArena& operator=(const CFrameArena& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	uint8_t*				m_pBlock;
+	size_t					m_nCapacity;
+	size_t					m_nOffset;		// Into m_pBlock
+	size_t					m_nUsed;		// Including the extra blocks
+	size_t					m_nPeak;
+	std::vector<void*>		m_Overflow;		// Extra blocks of this frame
+	unsigned long			m_nOverflows;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CArenaAllocator (Template Class)
+// Desc : Standard allocator over a CFrameArena. deallocate() does nothing,
+//		the memory comes back with the arena's Reset(), so a container
+//		using it must be gone (or cleared and not used again) by then.
+//-----------------------------------------------------------------------------
+template <typename T>
+class CArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	explicit CArenaAllocator(CFrameArena& arena) : m_pArena(&arena) {}
+	template <typename U>
+	CArenaAllocator(const CArenaAllocator<U>& other) : m_pArena(other.GetArena()) {}
+
+	T*				allocate(size_t n)
+	{
+		void* p = m_pArena->Allocate(n * sizeof(T), alignof(T));
+		if (!p)
+			throw std::bad_alloc();
+		return (T*)p;
+	}
+	void			deallocate(T*, size_t)		{ }
+
+	CFrameArena*	GetArena() const			{ return m_pArena; }
+
+	template <typename U>
+	bool operator==(const CArenaAllocator<U>& rhs) const { return m_pArena == rhs.GetArena(); }
+	template <typename U>
+	bool operator!=(const CArenaAllocator<U>& rhs) const { return m_pArena != rhs.GetArena(); }
+
+private:
+	CFrameArena*	m_pArena;
+};
+
+// A vector that lives until the arena's next Reset()
+template <typename T>
+using ArenaVector = std::vector<T, CArenaAllocator<T> >;
+
+#endif // _FRAMEARENA_H_
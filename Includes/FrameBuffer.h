@@ -0,0 +1,92 @@
+//-----------------------------------------------------------------------------
+// File: FrameBuffer.h
+//
+// Desc: Portable 32-bit software framebuffer. Pixels are stored as BGRA
+//	   (0x00RRGGBB when read as a little endian DWORD), which is the same
+//	   layout GDI uses for 32-bit DIBs, so the memory can be handed to the
+//	   window system as is.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _FRAMEBUFFER_H_
+#define _FRAMEBUFFER_H_
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const size_t FRAMEBUFFER_ALIGN = 64;	// Row / allocation alignment (cache line, AVX)
+
+inline uint32_t PackPixel(uint8_t r, uint8_t g, uint8_t b)
+{
+	return ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+}
+
+// Converts a GDI COLORREF (0x00BBGGRR) into framebuffer layout (0x00RRGGBB).
+inline uint32_t ColorRefToPixel(uint32_t cr)
+{
+	return PackPixel((uint8_t)(cr & 0xFF), (uint8_t)((cr >> 8) & 0xFF), (uint8_t)((cr >> 16) & 0xFF));
+}
+
+void*	AlignedAlloc(size_t size, size_t alignment = FRAMEBUFFER_ALIGN);
+void	AlignedFree(void* p);
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFrameBuffer (Class)
+// Desc : Aligned, strided block of 32-bit pixels. The buffer either owns its
+//		memory or wraps memory owned by somebody else (a DIB section).
+//-----------------------------------------------------------------------------
+class CFrameBuffer
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CFrameBuffer();
+			 CFrameBuffer(int width, int height);
+	virtual ~CFrameBuffer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool		Create(int width, int height);
+	void		Attach(uint32_t* pPixels, int width, int height, int pitch);
+	void		Release();
+
+	void		Clear(uint32_t color);
+	void		FillRect(int x, int y, int w, int h, uint32_t color);
+
+	uint32_t*		Pixels()		 { return m_pPixels; }
+	const uint32_t*	Pixels() const	 { return m_pPixels; }
+	uint32_t*		Row(int y)		 { return (uint32_t*)((uint8_t*)m_pPixels + (ptrdiff_t)y * m_iPitch); }
+	const uint32_t*	Row(int y) const { return (const uint32_t*)((const uint8_t*)m_pPixels + (ptrdiff_t)y * m_iPitch); }
+
+	int			Width() const	{ return m_iWidth; }
+	int			Height() const	{ return m_iHeight; }
+	int			Pitch() const	{ return m_iPitch; }	// Row stride in bytes
+	bool		IsValid() const	{ return m_pPixels != NULL; }
+
+private:
+	// Not copyable, a frame worth of pixels is too big to copy by accident.
+	CFrameBuffer(const CFrameBuffer& rhs);
+	CFrameBuffer& operator=(const CFrameBuffer& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class.
+	//-------------------------------------------------------------------------
+	uint32_t*	m_pPixels;
+	int			m_iWidth;
+	int			m_iHeight;
+	int			m_iPitch;
+	bool		m_bOwner;		// Did we allocate m_pPixels ?
+};
+
+#endif // _FRAMEBUFFER_H_
@@ -0,0 +1,193 @@
+//-----------------------------------------------------------------------------
+// File: GameWorld.h
+//
+// Desc: The game itself: every object in play and the rules that move them,
+//	   advanced one fixed step at a time. Knows nothing about windows, timers
+//	   or sound devices, so it runs the same inside the Win32 app and headless
+//	   on a build server.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _GAMEWORLD_H_
+#define _GAMEWORLD_H_
+
+//-----------------------------------------------------------------------------
+// CGameWorld Specific Includes
+//-----------------------------------------------------------------------------
+#include "Common.h"
+#include "CPlayer.h"
+#include "EntityStore.h"
+#include "FrameArena.h"
+#include "SpatialGrid.h"
+#include "DrawList.h"
+#include "Random.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// Everything from outside the world that one step depends on
+struct SGameInput
+{
+	unsigned long	nDirection;		// CPlayer::DIRECTION keys held
+	int				nFire;			// Shots asked for since the last step
+	int				iWidth;			// Play field, the client area of the
+	int				iHeight;		// window when there is one
+};
+
+// Bullets in flight at once, more are not fired. Sized well above play.
+const size_t PLAYER_BULLET_CAPACITY	= 256;
+const size_t ENEMY_BULLET_CAPACITY	= 1024;
+
+// Seed of a world not given one, any 64 bit value will do
+const uint64_t GAMEWORLD_DEFAULT_SEED = 1;
+
+// Each chicken and boss fires with this chance every step
+const float ENEMY_FIRE_CHANCE = 0.001f;
+
+// Random streams of the world, one per thing that draws from them, so
+// a change in how often one draws leaves the others as they were
+enum ERandomStream
+{
+	RANDOM_FIRE,				// Which enemies shoot
+	RANDOM_PICKUPS,				// Where health appears
+	RANDOM_STREAM_COUNT
+};
+
+// Images of the stored entities, the values of CEntityStore::Art()
+enum EEntityArt
+{
+	ART_BULLET,
+	ART_CHICKEN_BULLET,
+	ART_BOSS_BULLET,
+	ART_CHICKEN,
+	ART_HEALTH,
+	ART_BOSS,
+	ART_COUNT
+};
+
+struct SEntityArt
+{
+	CSpriteAsset*	pImage;
+	CSpriteAsset*	pDraw;			// Pre-scaled variant of pImage, or pImage
+	int				iWidth;			// Of pImage, unscaled like Sprite::width()
+	int				iHeight;
+	float			fScale;			// Of pDraw, and of the entities using it
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CGameWorld (Class)
+// Desc : Init() once, then Step() per fixed step of SIM_TIMESTEP seconds.
+//		Record() lists the sprites to draw and TakeSounds() the sounds to
+//		play, both are left to the caller. Everything random comes from
+//		the world's own streams of the seed given to Init(), so the same
+//		seed and input play the same game.
+//-----------------------------------------------------------------------------
+class CGameWorld
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CGameWorld();
+	virtual ~CGameWorld();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool			Init(uint64_t nSeed = GAMEWORLD_DEFAULT_SEED);
+	void			Release();
+	void			Step(const SGameInput& input);
+	void			Record(CDrawList& drawList);
+
+	// CPlayer::ESounds raised since the last call
+	unsigned int	TakeSounds();
+
+	// Fixed pools, nothing is allocated per shot. The counters of the
+	// stores tell how close play came to the capacity.
+	void			SetBulletCapacity(size_t nPlayer, size_t nEnemy);
+	const CEntityStore&	GetBullets() const		{ return m_Bullets; }
+	const CEntityStore&	GetEnemyBullets() const	{ return m_EnemyBullets; }
+
+	// Collisions test every pair instead of asking the spatial grids, to
+	// check the grids against
+	void			SetBruteForceCollisions(bool bBruteForce)	{ m_bBruteForce = bBruteForce; }
+	bool			IsBruteForceCollisions() const				{ return m_bBruteForce; }
+
+	// Scratch memory of a step, reset at its end
+	const CFrameArena&	GetStepArena() const	{ return m_StepArena; }
+
+	// Times one position update of count bullets kept as CBullet objects
+	// against the same update over a CEntityStore.
+	static bool		MeasureBulletUpdate(int count, int iterations, double& msObjects, double& msArrays);
+
+	// Times finding the overlapping pairs of bullets and targets by testing
+	// every pair against building a CSpatialGrid and querying it.
+	static bool		MeasureBroadphase(int bullets, int targets, int iterations, double& msBruteForce, double& msGrid);
+
+	// Everything that decides how the game goes on, as bytes LoadState()
+	// takes back into a world Init() has loaded. The player and the
+	// counters, the random streams and every entity, object ids included.
+	void			SaveState(std::vector<uint8_t>& state) const;
+	bool			LoadState(const uint8_t* pState, size_t nBytes);
+
+	// Everything that decides how the game goes on, folded into 64 bits:
+	// the random streams and the player's timers included. Object ids are
+	// left out, they are handed out process wide.
+	uint64_t		GetStateHash() const;
+
+	uint64_t		GetSeed() const				{ return m_nSeed; }
+	unsigned long	GetStepCount() const		{ return m_nStep; }
+	int				GetScore() const			{ return m_iScore; }
+	int				GetKilledChickens() const	{ return m_iKilledChickens; }
+	int				GetLevel() const			{ return m_iLevel; }
+	bool			IsGameOver() const			{ return m_bGameOver; }
+
+private:
+	CGameWorld(const CGameWorld& rhs);
+	CGameWorld& operator=(const CGameWorld& rhs);
+
+	void			CollideBullets(int width, int height);
+	static void		RemoveAll(CEntityStore& store, ArenaVector<uint32_t>& indices);
+	SSlotHandle		Spawn(CEntityStore& store, EEntityArt eArt, float x, float y, float vx, float vy);
+	void			Shoot(const CEntityStore& shooters, EEntityArt eBullet);
+	bool			BulletHits(size_t bullet, const CEntityStore& targets, size_t target, float& tHit) const;
+	bool			IsOutside(const CEntityStore& store, size_t index, int width, int height) const;
+	bool			HitsPlayer(const CEntityStore& store, size_t index) const;
+	bool			SweepsPlayer(const CEntityStore& store, size_t index, const SAabb& player, float& tHit) const;
+	size_t			FindPlayerHit(const CEntityStore& store);
+	bool			SweepHits(const CEntityStore& store, size_t index, float tEnter, float tExit,
+							  const CHitMask& mask, int x, int y, float& tHit) const;
+	SAabb			GetDrawBox(const CEntityStore& store, size_t index, float t = 1.0f) const;
+	SAabb			GetSweepBox(const CEntityStore& store, size_t index) const;
+	const CHitMask&	GetHitMask(const CEntityStore& store, size_t index) const;
+	void			Record(CDrawList& drawList, const CEntityStore& store, EDrawLayer eLayer) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	CPlayer*				m_pPlayer;
+	CEntityStore			m_Bullets;			// The player's
+	CEntityStore			m_EnemyBullets;		// Chickens' and bosses'
+	CEntityStore			m_Chickens;
+	CEntityStore			m_Health;
+	CEntityStore			m_Bosses;
+	SEntityArt				m_Art[ART_COUNT];
+	CFrameArena				m_StepArena;
+	CSpatialGrid			m_TargetGrid;		// Chickens and bosses
+	bool					m_bBruteForce;
+	uint64_t				m_nSeed;
+	CRandom					m_Random[RANDOM_STREAM_COUNT];	// Streams of m_nSeed
+
+	unsigned long			m_nStep;
+	int						m_iScore;
+	int						m_iKilledChickens;
+	int						m_iLevel;
+	float					m_fExplosionTime;	// Since the last explosion frame
+	bool					m_bGameOver;
+};
+
+#endif // _GAMEWORLD_H_
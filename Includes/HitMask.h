@@ -0,0 +1,73 @@
+//-----------------------------------------------------------------------------
+// File: HitMask.h
+//
+// Desc: One bit per pixel coverage of a masked image, packed 64 pixels to a
+//	   word, so two images can be tested for touching pixels a row of 64 at
+//	   a time.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _HITMASK_H_
+#define _HITMASK_H_
+
+//-----------------------------------------------------------------------------
+// CHitMask Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CHitMask (Class)
+// Desc : Built from the alpha channel of an image whose mask has been baked
+//		in, like CRleImage: pixel x of row y is bit x % 64 of word x / 64 of
+//		the row, set when the pixel is drawn. Bits past the width are
+//		clear.
+//-----------------------------------------------------------------------------
+class CHitMask
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CHitMask();
+	virtual ~CHitMask();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool			Build(const CFrameBuffer& image);
+
+	// base resized to width x height by nearest sampling, the way
+	// CBlitter::BlitStretched() picks source pixels. Integer math only, so
+	// every build decides hits on a scaled image on the same pixels,
+	// however the image itself was filtered.
+	bool			BuildScaled(const CHitMask& base, int width, int height);
+	void			Release();
+
+	bool			IsValid() const		{ return !m_Bits.empty(); }
+	int				Width() const		{ return m_iWidth; }
+	int				Height() const		{ return m_iHeight; }
+
+	const uint64_t*	Row(int y) const	{ return &m_Bits[0] + (size_t)y * m_nWords; }
+	bool			Test(int x, int y) const	{ return (Row(y)[x >> 6] >> (x & 63)) & 1; }
+
+	// Whether a drawn with its upper-left pixel at (ax, ay) and b drawn at
+	// (bx, by) have a pixel in common. An invalid mask has none.
+	static bool		Overlap(const CHitMask& a, int ax, int ay, const CHitMask& b, int bx, int by);
+
+private:
+	uint64_t		GetBits(const uint64_t* pRow, int x) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<uint64_t>	m_Bits;			// Height rows of m_nWords
+	int						m_nWords;
+	int						m_iWidth;
+	int						m_iHeight;
+};
+
+#endif // _HITMASK_H_
@@ -16,11 +16,9 @@
 #include "..\\Res\\resource.h"
 #include <windows.h>
 #include <crtdbg.h>
-#include <assert.h> 
 #include "Commdlg.h"
 #include <tchar.h>
-#include <stdio.h>
-#include <math.h>
+#include "Common.h"
 
 
 //-----------------------------------------------------------------------------
@@ -29,18 +27,4 @@
 #define CAPS1			94
 #define C1_TRANSPARENT	1
 
-
-#define EPS 1e-3 // epsilon (the smallest float value used)
-#define PI 3.14159265358979323846
-#define DEG2RAD(deg) (PI * (deg) / 180.0)
-#define RAD2DEG(rad) ((rad) * 180.0 / PI)
-
-inline float FRand(float a, float b){
-	float random = ((float)rand()) / (float)RAND_MAX;
-	float diff = b - a;
-	float r = random * diff;
-	return a + r;
-
-}
-
 #endif // _MAIN_H_
\ No newline at end of file
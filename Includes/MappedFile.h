@@ -0,0 +1,59 @@
+//-----------------------------------------------------------------------------
+// File: MappedFile.h
+//
+// Desc: Read only view of a whole file mapped into memory, so large files
+//	   are paged in as they are touched instead of read up front.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+//-----------------------------------------------------------------------------
+// CMappedFile Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CMappedFile (Class)
+// Desc : File mapping on Windows, mmap() elsewhere. An empty file opens
+//		with no data.
+//-----------------------------------------------------------------------------
+class CMappedFile
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CMappedFile();
+	virtual ~CMappedFile();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool			Open(const char* szFileName);
+	void			Close();
+	bool			IsOpen() const		{ return m_bOpen; }
+
+	const uint8_t*	Data() const		{ return m_pData; }
+	size_t			Size() const		{ return m_nSize; }
+
+private:
+	CMappedFile(const CMappedFile& rhs);
+	CMappedFile& operator=(const CMappedFile& rhs);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	const uint8_t*	m_pData;
+	size_t			m_nSize;
+	bool			m_bOpen;
+	void*			m_hFile;			// Windows file and mapping handles
+	void*			m_hMapping;
+};
+
+#endif // _MAPPEDFILE_H_
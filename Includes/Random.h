@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// File: Random.h
+//
+// Desc: Small, fast pseudo random generator with its own state, so every
+//	   user draws from a stream of its own that repeats exactly from the
+//	   same seed.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _RANDOM_H_
+#define _RANDOM_H_
+
+//-----------------------------------------------------------------------------
+// CRandom Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CRandom (Class)
+// Desc : xoshiro128**, 32 bit operations only, period 2^128 - 1. Seed()
+//		spreads a 64 bit seed over the state, then jumps 2^64 draws ahead
+//		once per stream number: the streams of one seed are stretches of
+//		the same sequence that never overlap. Not for anything that needs
+//		to be unpredictable.
+//-----------------------------------------------------------------------------
+class CRandom
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CRandom(uint64_t nSeed = 0, uint32_t nStream = 0);
+	virtual ~CRandom();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Seed(uint64_t nSeed, uint32_t nStream = 0);
+	void			Jump();							// 2^64 draws ahead
+
+	uint32_t		Next()
+	{
+		uint32_t nResult = Rotate(m_nState[1] * 5, 7) * 9;
+		uint32_t t = m_nState[1] << 9;
+
+		m_nState[2] ^= m_nState[0];
+		m_nState[3] ^= m_nState[1];
+		m_nState[1] ^= m_nState[2];
+		m_nState[0] ^= m_nState[3];
+		m_nState[2] ^= t;
+		m_nState[3] = Rotate(m_nState[3], 11);
+
+		return nResult;
+	}
+
+	// From 0 to n - 1, n above 0
+	uint32_t		NextBelow(uint32_t n)			{ return (uint32_t)(((uint64_t)Next() * n) >> 32); }
+
+	// From 0 up to but not including 1, in steps of 2^-24
+	float			NextFloat()						{ return (float)(Next() >> 8) * (1.0f / 16777216.0f); }
+	float			NextFloat(float a, float b)		{ return a + (b - a) * NextFloat(); }
+
+	// The next count draws at once, the same values the single calls give
+	void			Fill(uint32_t* pOut, size_t count);
+	void			FillFloat(float* pOut, size_t count, float a = 0.0f, float b = 1.0f);
+
+	// The stream exactly where it is, to carry on from later
+	void			GetState(uint32_t state[4]) const;
+	bool			SetState(const uint32_t state[4]);
+
+private:
+	static uint32_t	Rotate(uint32_t x, int k)		{ return (x << k) | (x >> (32 - k)); }
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	uint32_t		m_nState[4];					// Never all zero
+};
+
+#endif // _RANDOM_H_
@@ -0,0 +1,217 @@
+//-----------------------------------------------------------------------------
+// File: Replay.h
+//
+// Desc: Recording the input of every simulation step, with the run seed,
+//	   to a compact binary log, and playing a log back headless to check
+//	   the world still steps the same. Whole world states are kept every
+//	   few seconds of play and indexed at the end of the file, so any step
+//	   is reached from the nearest one instead of from the start.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _REPLAY_H_
+#define _REPLAY_H_
+
+//-----------------------------------------------------------------------------
+// CReplay Specific Includes
+//-----------------------------------------------------------------------------
+#include "GameWorld.h"
+#include "MappedFile.h"
+#include "FixedTimestep.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const uint32_t	REPLAY_MAGIC			= 0x4C505243;	// "CRPL"
+const uint16_t	REPLAY_VERSION			= 3;
+const uint32_t	REPLAY_HASH_INTERVAL	= 60;			// Steps between stored state hashes
+const double	REPLAY_KEYFRAME_SECONDS	= 10.0;			// Of play between world states
+const char* const REPLAY_SESSION_FILE	= "session.rpl";	// Where the game records itself
+
+// Start of a log, then one record per step with keyframes between them,
+// then the keyframe index and the trailer
+struct SReplayHeader
+{
+	uint32_t	nMagic;
+	uint16_t	nVersion;
+	uint16_t	nReserved;
+	uint32_t	nHashInterval;
+	uint32_t	nKeyframeInterval;	// Steps
+	uint64_t	nSeed;				// Given to CGameWorld::Init()
+};
+
+// A keyframe is REPLAY_KEYFRAME, the state's size in 32 bits, the rolling
+// hash so far and CGameWorld::SaveState() after nStep steps. The first
+// one is the state Init() leaves.
+struct SReplayKeyframe
+{
+	uint32_t	nStep;
+	uint32_t	nReserved;
+	uint64_t	nOffset;			// Of its REPLAY_KEYFRAME byte
+};
+
+// Last bytes of a file closed properly. Without it the keyframes are
+// found by walking the records.
+struct SReplayTrailer
+{
+	uint64_t	nIndexOffset;		// Of nKeyframes SReplayKeyframe, where the records end
+	uint32_t	nKeyframes;
+	uint32_t	nSteps;
+	uint32_t	nMagic;				// REPLAY_INDEX_MAGIC
+	uint32_t	nReserved;
+};
+
+const uint32_t	REPLAY_INDEX_MAGIC		= 0x58495243;	// "CRIX"
+
+// First byte of a step record: the direction keys in the low four bits,
+// then which of the optional fields follow, in this order
+const uint8_t	REPLAY_DIRECTION_MASK	= 0x0F;
+const uint8_t	REPLAY_HAS_FIRE			= 0x10;			// Shots, a varint
+const uint8_t	REPLAY_HAS_FIELD		= 0x20;			// Width and height, 16 bits each, when changed
+const uint8_t	REPLAY_HAS_HASH			= 0x40;			// Rolling state hash after the step, 64 bits
+const uint8_t	REPLAY_KEYFRAME			= 0x80;			// Not a step, a keyframe follows
+
+// Each stored hash folds in the one before, so a difference once seen
+// stays in every hash after it
+inline uint64_t RollStateHash(uint64_t nRolling, uint64_t nState)
+{
+	return (nRolling ^ nState) * 0x9E3779B97F4A7C15ULL + 0x632BE59BD9B4E019ULL;
+}
+
+// What playing a log back found
+struct SReplayResult
+{
+	unsigned long	nSteps;				// Played
+	unsigned long	nHashes;			// Compared
+	unsigned long	nDivergedStep;		// First stored hash that differed, 0 if none
+	unsigned long	nLastMatchStep;		// The last one that still matched before it
+	int				iScore;				// At the end
+	bool			bGameOver;
+	double			fSeconds;			// Stepping only, loading left out
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CReplayWriter (Class)
+// Desc : Open() with the world just after Init(), then Write() after
+//		every Step() with the input it was given. A step holding no key
+//		changes, shots or resizes takes one byte. Close() writes the
+//		index.
+//-----------------------------------------------------------------------------
+class CReplayWriter
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CReplayWriter();
+	virtual ~CReplayWriter();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool			Open(const char* szFileName, const CGameWorld& world, uint32_t nHashInterval = REPLAY_HASH_INTERVAL,
+						 uint32_t nKeyframeInterval = (uint32_t)(REPLAY_KEYFRAME_SECONDS / SIM_TIMESTEP + 0.5));
+	void			Close();
+	bool			IsOpen() const			{ return m_pFile != NULL; }
+
+	void			Write(const SGameInput& input, const CGameWorld& world);
+
+	unsigned long	GetStepCount() const	{ return m_nSteps; }
+
+private:
+	CReplayWriter(const CReplayWriter& rhs);
+	CReplayWriter& operator=(const CReplayWriter& rhs);
+
+	void			WriteBytes(const void* pData, size_t nBytes);
+	void			WriteKeyframe(const CGameWorld& world);
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	FILE*			m_pFile;
+	uint64_t		m_nOffset;				// Bytes written
+	uint32_t		m_nHashInterval;
+	uint32_t		m_nKeyframeInterval;
+	unsigned long	m_nSteps;
+	uint64_t		m_nRolling;
+	int				m_iWidth;				// Last written play field
+	int				m_iHeight;
+	std::vector<uint8_t>			m_State;	// Kept between keyframes
+	std::vector<SReplayKeyframe>	m_Index;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CReplayReader (Class)
+// Desc : Maps a log into memory, then hands out its steps in order with
+//		Read(), steps a world through them with Step(), or puts a world at
+//		any step with Seek(). Play() runs all of it through a world of its
+//		own.
+//-----------------------------------------------------------------------------
+class CReplayReader
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CReplayReader();
+	virtual ~CReplayReader();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool			Open(const char* szFileName);
+	void			Close();
+
+	const SReplayHeader&	GetHeader() const		{ return m_Header; }
+	unsigned long	GetStepCount() const			{ return m_nSteps; }
+	size_t			GetKeyframeCount() const		{ return m_Keyframes.size(); }
+
+	// The next step's input, and the hash stored after it when bHash is
+	// set. Keyframes are passed over. False at the end of the log, or
+	// where it is cut short.
+	bool			Read(SGameInput& input, bool& bHash, uint64_t& nHash);
+	void			Rewind();
+
+	// Reads the next step into world, checking the state hash when the
+	// log has one there: bMatch is cleared when it differs.
+	bool			Step(CGameWorld& world, bool& bMatch);
+
+	// Loads the last keyframe at or before nStep into world, which Init()
+	// has loaded, and steps on to nStep. Later Step() calls carry on from
+	// there. False past the end or when a hash on the way differs.
+	bool			Seek(CGameWorld& world, unsigned long nStep);
+
+	// Every step from the start, as fast as the world steps, nothing
+	// drawn. Stops at the first hash that differs. False when the log or
+	// the world's images cannot be loaded.
+	bool			Play(SReplayResult& result);
+
+	// Times Seek() to nSeeks steps spread over the log, in milliseconds.
+	bool			MeasureSeek(int nSeeks, double& msMean, double& msMax);
+
+private:
+	bool			ReadBytes(void* pData, size_t nBytes);
+	bool			ReadIndex();
+	bool			ScanIndex();
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	CMappedFile				m_File;
+	size_t					m_nEnd;			// Of the records
+	size_t					m_nOffset;		// Of the next one
+	SReplayHeader			m_Header;
+	unsigned long			m_nSteps;
+	std::vector<SReplayKeyframe>	m_Keyframes;
+	uint64_t				m_nRolling;		// Of the steps read so far
+	int						m_iWidth;		// Play field of the last record
+	int						m_iHeight;
+};
+
+#endif // _REPLAY_H_
@@ -1,6 +1,7 @@
 #pragma once
 #include "Filters.h"
 #include "ImageFile.h"
+#include "FrameBuffer.h"
 
 class CWeightsTable
 {
@@ -55,6 +56,11 @@ public:
 	// Scale an image to the desired dimensions
 	void Resample(unsigned dst_width, unsigned dst_height);
 
+	// Move pixels between the image and a framebuffer, the alpha channel
+	// travels in rgbReserved and is filtered like the colors.
+	bool LoadFromFrameBuffer(const CFrameBuffer& src);
+	bool CopyToFrameBuffer(CFrameBuffer& dst) const;
+
 private:
 	void ScaleRow(unsigned int dst_width, unsigned int /*dst_height*/, unsigned int row);
 	void ScaleCol(unsigned int dst_width, unsigned int dst_height, unsigned int col);
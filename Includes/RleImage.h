@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// File: RleImage.h
+//
+// Desc: Run-length encoded opaque spans of a masked image. Each row is stored
+//	   as a list of (x, length) runs of drawable pixels so the blitter can
+//	   copy them whole and never look at the transparent ones.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _RLEIMAGE_H_
+#define _RLEIMAGE_H_
+
+//-----------------------------------------------------------------------------
+// CRleImage Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+struct SRleSpan
+{
+	uint16_t	x;			// First opaque pixel of the run
+	uint16_t	length;		// Number of opaque pixels
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CRleImage (Class)
+// Desc : Span table built from the alpha channel of an image whose mask has
+//		been baked in (alpha 0x00 = transparent, anything else = opaque). The
+//		pixels themselves stay in the source image.
+//-----------------------------------------------------------------------------
+class CRleImage
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CRleImage();
+	virtual ~CRleImage();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	bool			Build(const CFrameBuffer& image);
+	void			Release();
+
+	bool			IsValid() const		{ return !m_RowStart.empty(); }
+	int				Width() const		{ return m_iWidth; }
+	int				Height() const		{ return m_iHeight; }
+
+	// Spans of row y, sorted by x and never overlapping.
+	const SRleSpan*	RowBegin(int y) const	{ return m_Spans.empty() ? NULL : &m_Spans[0] + m_RowStart[y]; }
+	const SRleSpan*	RowEnd(int y) const		{ return m_Spans.empty() ? NULL : &m_Spans[0] + m_RowStart[y + 1]; }
+
+	size_t			GetSpanCount() const	{ return m_Spans.size(); }
+	size_t			GetOpaqueCount() const	{ return m_nOpaque; }
+	float			GetOpaqueRatio() const;
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<SRleSpan>	m_Spans;
+	std::vector<uint32_t>	m_RowStart;		// Height + 1 offsets into m_Spans
+	size_t					m_nOpaque;
+	int						m_iWidth;
+	int						m_iHeight;
+};
+
+#endif // _RLEIMAGE_H_
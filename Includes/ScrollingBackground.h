@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------------
+// File: ScrollingBackground.h
+//
+// Desc: Vertically scrolling background that wraps around. The image stays
+//	   resident in framebuffer format and each frame copies only the part
+//	   the screen shows.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SCROLLINGBACKGROUND_H_
+#define _SCROLLINGBACKGROUND_H_
+
+//-----------------------------------------------------------------------------
+// CScrollingBackground Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const float BACKGROUND_SCROLL_SPEED = 30.0f;	// Pixels per second
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CScrollingBackground (Class)
+// Desc : The image moves up the screen. Screen row 0 shows image row
+//		GetRow(), the rows below follow and continue from the top of the
+//		image past its last row.
+//-----------------------------------------------------------------------------
+class CScrollingBackground
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CScrollingBackground();
+	virtual ~CScrollingBackground();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// The image is not copied and must outlive the background. An asset's
+	// image can be given, it stays the same object when the atlas is rebuilt.
+	void			SetImage(const CFrameBuffer* pImage);
+
+	void			Update(float fTimeElapsed);
+	void			Draw(CFrameBuffer& target, int originX = 0, int originY = 0) const;
+
+	void			SetSpeed(float fSpeed)		{ m_fSpeed = fSpeed; }
+	float			GetSpeed() const			{ return m_fSpeed; }
+	void			SetScrolling(bool bScroll)	{ m_bScrolling = bScroll; }
+	bool			IsScrolling() const			{ return m_bScrolling; }
+
+	// Image row at the top of the screen. The position itself is kept to
+	// a fraction of a pixel, so slow speeds still move on time.
+	int				GetRow() const				{ return (int)m_fOffset; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	const CFrameBuffer*	m_pImage;
+	float				m_fOffset;		// In [0, image height)
+	float				m_fSpeed;
+	bool				m_bScrolling;
+};
+
+#endif // _SCROLLINGBACKGROUND_H_
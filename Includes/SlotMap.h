@@ -0,0 +1,90 @@
+//-----------------------------------------------------------------------------
+// File: SlotMap.h
+//
+// Desc: Generational handles onto densely packed elements. The elements
+//	   themselves live in the owner's arrays, this keeps the mapping from a
+//	   handle to where its element is now.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SLOTMAP_H_
+#define _SLOTMAP_H_
+
+//-----------------------------------------------------------------------------
+// CSlotMap Specific Includes
+//-----------------------------------------------------------------------------
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const size_t SLOT_NONE = (size_t)-1;		// Find() of a stale or null handle
+
+// A zeroed handle is the null handle, generations start at 1
+struct SSlotHandle
+{
+	uint32_t	nSlot;
+	uint32_t	nGeneration;
+
+	bool operator==(const SSlotHandle& rhs) const { return nSlot == rhs.nSlot && nGeneration == rhs.nGeneration; }
+	bool operator!=(const SSlotHandle& rhs) const { return !(*this == rhs); }
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSlotMap (Class)
+// Desc : Insert() hands out a handle for the next dense index. Remove()
+//		tells the owner which dense index to fill with its last element,
+//		the usual swap and pop, and remaps the moved element. A removed
+//		slot's generation is bumped before it is reused, so old handles to
+//		it stop resolving. Everything is O(1).
+//-----------------------------------------------------------------------------
+class CSlotMap
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSlotMap();
+	virtual ~CSlotMap();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// The new element goes at dense index Size() - 1
+	SSlotHandle		Insert();
+
+	// Both return the dense index the owner must overwrite with its last
+	// element before dropping that. Remove() of a stale handle does
+	// nothing and returns SLOT_NONE.
+	size_t			Remove(SSlotHandle handle);
+	size_t			RemoveAt(size_t index);
+
+	size_t			Find(SSlotHandle handle) const;
+	bool			IsValid(SSlotHandle handle) const	{ return Find(handle) != SLOT_NONE; }
+	SSlotHandle		GetHandle(size_t index) const;
+
+	void			Clear();
+	void			Reserve(size_t count);
+	size_t			Size() const						{ return m_DenseSlot.size(); }
+
+private:
+	struct SSlot
+	{
+		uint32_t	nIndex;			// Dense index while live, next free slot when not
+		uint32_t	nGeneration;	// Odd while live
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<SSlot>		m_Slots;
+	std::vector<uint32_t>	m_DenseSlot;	// Slot of each dense element
+	uint32_t				m_nFreeHead;	// First free slot, or none
+};
+
+#endif // _SLOTMAP_H_
@@ -0,0 +1,84 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.h
+//
+// Desc: Uniform grid over the play field, hashed into a fixed number of
+//	   buckets, for finding which boxes may overlap a given one without
+//	   testing all of them.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _SPATIALGRID_H_
+#define _SPATIALGRID_H_
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include "AabbBatch.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const float SPATIALGRID_CELL_SIZE = 128.0f;		// About a chicken or an enemy bullet
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSpatialGrid (Class)
+// Desc : Build() files the index of every box under each cell it covers,
+//		Query() gathers the boxes filed under the cells of another box and
+//		keeps the ones that overlap it. Cells hash into buckets, so the
+//		field is unbounded and the memory follows the number of boxes,
+//		not the size of the field. Boxes with a NaN or infinite edge are
+//		neither filed nor found. Built again whenever the boxes move;
+//		the arrays are kept, so building the same number of boxes does
+//		not allocate.
+//-----------------------------------------------------------------------------
+class CSpatialGrid
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CSpatialGrid(float fCellSize = SPATIALGRID_CELL_SIZE);
+	virtual ~CSpatialGrid();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void			Build(const SAabb* pBoxes, size_t count);
+	void			Reserve(size_t count, size_t nCellsEach = 4);
+
+	// Indices of the boxes overlapping box, ascending and each once. Valid
+	// until the next Query() or Build().
+	const std::vector<uint32_t>&	Query(const SAabb& box);
+
+	size_t			GetBoxCount() const		{ return m_Boxes.size(); }
+	size_t			GetEntryCount() const	{ return m_Entries.size(); }	// Box and cell pairs
+
+private:
+	bool			GetCells(const SAabb& box, int& x0, int& y0, int& x1, int& y1) const;
+	uint32_t		GetBucket(int x, int y) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	float					m_fCellSize;
+	float					m_fInvCellSize;
+	uint32_t				m_nBucketMask;		// Bucket count - 1, a power of two
+	std::vector<SAabb>		m_Boxes;			// Copy of the last Build()
+	int						m_iMinCellX;		// Cells the built boxes cover, queries
+	int						m_iMinCellY;		// look no further
+	int						m_iMaxCellX;
+	int						m_iMaxCellY;
+	std::vector<uint32_t>	m_BucketStart;		// Into m_Entries, one past the last bucket too
+	std::vector<uint32_t>	m_Entries;			// Box indices, grouped by bucket
+	std::vector<uint32_t>	m_Stamp;			// Per box, the last query that saw it
+	uint32_t				m_nQuery;
+	std::vector<uint32_t>	m_Result;
+};
+
+#endif // _SPATIALGRID_H_
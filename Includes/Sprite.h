@@ -4,28 +4,54 @@
 #ifndef SPRITE_H
 #define SPRITE_H
 
-#include "main.h"
+#include "Common.h"
 #include "Vec2.h"
-#include "BackBuffer.h"
+#include "AssetCache.h"
+#include "DrawList.h"
+
+class BackBuffer;
 
 class Sprite
 {
 public:
+#ifdef _WIN32
 	Sprite(int imageID, int maskID);
+#endif
 	Sprite(const char *szImageFile, const char *szMaskFile);
-	Sprite(const char *szImageFile, COLORREF crTransparentColor);
+	// The key color is a framebuffer pixel, see PackPixel().
+	Sprite(const char *szImageFile, uint32_t nTransparentColor);
 
 	virtual ~Sprite();
 
-	int width(){ return mImageBM.bmWidth; }
-	int height(){ return mImageBM.bmHeight; }
+	int width(){ return mpImage ? mpImage->Width() : 0; }
+	int height(){ return mpImage ? mpImage->Height() : 0; }
 	void setScale(float, float);
 	Vec2 getScale();
 	void update(float dt);
 
+	// The image draw() puts on screen, with its upper-left corner and size.
+	// Hit tests look at these, mPosition is the center of the unscaled image.
+	const CSpriteAsset* drawnImage() const { return mpScaled ? mpScaled : mpImage; }
+	SAtlasRect drawnRect() const;
+
 	void setBackBuffer(const BackBuffer *pBackBuffer);
+	// Unique for the life of the program, tags the sprite's draws.
+	uint32_t getId() const { return mId; }
+	// For objects that draw without a Sprite, never the id of one.
+	static uint32_t newId() { return msNextId++; }
+
+	// Draws iCount copies of a color keyed image at fScale, scattered over
+	// an 800x600 frame, through the stretched keyed blit that tests the key
+	// on every pixel of every draw and through the mask and scaled copy
+	// cached with the asset. Results are in draws per second; false if the
+	// image does not load.
+	static bool measureDraws(const char *szImageFile, uint32_t nTransparentColor, float fScale, int iCount,
+							 double &fStretched, double &fCached);
 	virtual void draw();
 
+	// Records the draw instead of blitting now, see CDrawList.
+	virtual void draw(CDrawList& drawList, EDrawLayer eLayer);
+
 public:
 	// Keep these public because they need to be
 	// modified externally frequently.
@@ -41,18 +67,19 @@ private:
 	Sprite& operator=(const Sprite& rhs);
 
 protected:
-	HBITMAP mhImage;
-	HBITMAP mhMask;
-	BITMAP mImageBM;
-	BITMAP mMaskBM;
+	// Shared image data, owned by the asset cache.
+	CSpriteAsset *mpImage;
+	CSpriteAsset *mpMask;
+	CSpriteAsset *mpScaled;	// Pre-scaled copy of mpImage, NULL at scale 1
 
-	HDC mhSpriteDC;
 	const BackBuffer *mpBackBuffer;
 
 	float mfScaleX;
 	float mfScaleY;
 
-	COLORREF mcTransparentColor;
+	uint32_t mnTransparentColor;
+	uint32_t mId;
+	static uint32_t msNextId;
 	void drawTransparent();
 	void drawMask();
 };
@@ -63,19 +90,20 @@ protected:
 class AnimatedSprite : public Sprite
 {
 public:
-	//NOTE: The animation is on a single row.
-	AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount);
+	//NOTE: The frames are a grid, 4 per row, starting at rcFirstFrame.
+	AnimatedSprite(const char *szImageFile, const char *szMaskFile, const SAtlasRect& rcFirstFrame, int iFrameCount);
 	virtual ~AnimatedSprite() { }
 
 public:
 	void SetFrame(int iIndex);
+	bool SetFrame(const char *szName);
 	int GetFrameCount() { return miFrameCount; }
 
 	virtual void draw();
+	virtual void draw(CDrawList& drawList, EDrawLayer eLayer);
 	
 protected:
-	POINT mptFrameStartCrop;// first point of the frame (upper-left corner)
-	POINT mptFrameCrop;		// crop point of frame
+	int miFrame;			// current frame, an index into the image's named frames
 	int miFrameWidth;		// width
 	int miFrameHeight;		// height
 	int miFrameCount;		// number of frames
@@ -0,0 +1,146 @@
+//-----------------------------------------------------------------------------
+// File: TextureAtlas.h
+//
+// Desc: Packs many small images into a few large surfaces (skyline bottom
+//	   left packing) and keeps a table of named rectangles into them.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _TEXTUREATLAS_H_
+#define _TEXTUREATLAS_H_
+
+//-----------------------------------------------------------------------------
+// CTextureAtlas Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include <map>
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int ATLAS_PAGE_SIZE = 2048;	// Default page width / maximum page height
+
+struct SAtlasRect
+{
+	int			x, y;
+	int			w, h;
+};
+
+struct SAtlasEntry
+{
+	std::string	strName;
+	int			iPage;		// Index of the surface holding the rectangle
+	SAtlasRect	rc;			// Position on that surface
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CSkylinePacker (Class)
+// Desc : Skyline bottom-left rectangle packer. The skyline is the top edge of
+//		everything placed so far; each rectangle goes where its top ends up
+//		lowest.
+//-----------------------------------------------------------------------------
+class CSkylinePacker
+{
+public:
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void		Init(int width, int height);
+	bool		Insert(int w, int h, int& x, int& y);
+
+	int			GetUsedWidth() const	{ return m_iUsedWidth; }
+	int			GetUsedHeight() const	{ return m_iUsedHeight; }
+	size_t		GetUsedArea() const		{ return m_nUsedArea; }
+
+private:
+	struct SSkylineNode
+	{
+		int		x, y, w;
+	};
+
+	int			Fit(size_t index, int w, int h) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<SSkylineNode>	m_Skyline;
+	int							m_iWidth;
+	int							m_iHeight;
+	int							m_iUsedWidth;
+	int							m_iUsedHeight;
+	size_t						m_nUsedArea;
+};
+
+//-----------------------------------------------------------------------------
+// Name : CTextureAtlas (Class)
+// Desc : Queue images with AddImage (and named sub-rectangles of them with
+//		AddSubRect), then Pack() copies them onto as few surfaces as fit and
+//		fills the rect table. The queued images must stay alive until then.
+//-----------------------------------------------------------------------------
+class CTextureAtlas
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CTextureAtlas();
+	virtual ~CTextureAtlas();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	void				AddImage(const std::string& strName, const CFrameBuffer* pImage);
+	void				AddSubRect(const std::string& strName, const std::string& strImage, const SAtlasRect& rc);
+	bool				Pack(int pageSize = ATLAS_PAGE_SIZE);
+	void				Clear();
+	void				Swap(CTextureAtlas& other);
+
+	const SAtlasEntry*	Find(const std::string& strName) const;
+	size_t				GetEntryCount() const		{ return m_Entries.size(); }
+	const SAtlasEntry&	GetEntry(size_t i) const	{ return m_Entries[i]; }
+
+	int					GetPageCount() const		{ return (int)m_Pages.size(); }
+	CFrameBuffer&		GetPage(int i)				{ return *m_Pages[i]; }
+	const CFrameBuffer&	GetPage(int i) const		{ return *m_Pages[i]; }
+
+	// Share of the page area covered by images, 1.0 is a perfect pack.
+	float				GetOccupancy() const;
+
+	// Writes the rect table as text, one "name page x y w h" line per entry.
+	bool				SaveRectTable(const char* szFileName) const;
+	std::string			FormatRectTable() const;
+
+private:
+	CTextureAtlas(const CTextureAtlas& rhs);
+	CTextureAtlas& operator=(const CTextureAtlas& rhs);
+
+	struct SPendingImage
+	{
+		std::string			strName;
+		const CFrameBuffer*	pImage;
+	};
+
+	struct SPendingRect
+	{
+		std::string			strName;
+		std::string			strImage;
+		SAtlasRect			rc;
+	};
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<SPendingImage>		m_PendingImages;
+	std::vector<SPendingRect>		m_PendingRects;
+	std::vector<CFrameBuffer*>		m_Pages;
+	std::vector<SAtlasEntry>		m_Entries;
+	std::map<std::string, size_t>	m_Index;		// Name -> m_Entries slot
+	size_t							m_nImageArea;
+};
+
+#endif // _TEXTUREATLAS_H_
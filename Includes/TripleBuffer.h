@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// File: TripleBuffer.h
+//
+// Desc: Lock-free hand-off of whole values from one producer thread to one
+//	   consumer thread.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _TRIPLEBUFFER_H_
+#define _TRIPLEBUFFER_H_
+
+//-----------------------------------------------------------------------------
+// CTripleBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTripleBuffer (Template Class)
+// Desc : The writer fills GetWriteBuffer() and calls Publish(). The reader
+//		calls Acquire() and then reads GetReadBuffer(), which stays the same
+//		until its next Acquire(). Three slots mean neither side ever waits:
+//		one is being written, one is being read and the third holds the
+//		latest published value. Slots are swapped with one atomic exchange,
+//		so a slot is reused (keeping its vectors' capacity), never copied.
+//-----------------------------------------------------------------------------
+template <typename T>
+class CTripleBuffer
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	CTripleBuffer() : m_nMiddle(1), m_iBack(0), m_iFront(2) {}
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// Writer side
+	T&				GetWriteBuffer()	{ return m_Buffers[m_iBack]; }
+	void			Publish()
+	{
+		m_iBack = m_nMiddle.exchange(m_iBack | FRESH, std::memory_order_acq_rel) & INDEX;
+	}
+
+	// True while the last published value has not been acquired yet
+	bool			IsPending() const	{ return (m_nMiddle.load(std::memory_order_acquire) & FRESH) != 0; }
+
+	// Reader side. Returns false (keeping the old value) if nothing new
+	// was published since the last call.
+	bool			Acquire()
+	{
+		if (!IsPending())
+			return false;
+
+		m_iFront = m_nMiddle.exchange(m_iFront, std::memory_order_acq_rel) & INDEX;
+		return true;
+	}
+	const T&		GetReadBuffer() const	{ return m_Buffers[m_iFront]; }
+
+private:
+	CTripleBuffer(const CTripleBuffer& rhs);
+	CTripleBuffer& operator=(const CTripleBuffer& rhs);
+
+	enum { INDEX = 3, FRESH = 4 };
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	T							m_Buffers[3];
+	std::atomic<unsigned int>	m_nMiddle;		// Slot index, plus FRESH once published
+	unsigned int				m_iBack;		// Writer's slot
+	unsigned int				m_iFront;		// Reader's slot
+};
+
+#endif // _TRIPLEBUFFER_H_
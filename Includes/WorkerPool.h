@@ -0,0 +1,74 @@
+//-----------------------------------------------------------------------------
+// File: WorkerPool.h
+//
+// Desc: Small pool of worker threads that run an indexed job in parallel.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _WORKERPOOL_H_
+#define _WORKERPOOL_H_
+
+//-----------------------------------------------------------------------------
+// CWorkerPool Specific Includes
+//-----------------------------------------------------------------------------
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CWorkerPool (Class)
+// Desc : Run(count, job) calls job(0) ... job(count - 1) spread over the
+//		workers and the calling thread, and returns when all are done.
+//		Indices are handed out one at a time, so uneven jobs balance out.
+//		Only one thread may call Run() at a time.
+//-----------------------------------------------------------------------------
+class CWorkerPool
+{
+public:
+	//-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+			 CWorkerPool();
+	virtual ~CWorkerPool();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+	// nThreads counts the caller, so 1 starts no workers. 0 means one per
+	// hardware thread.
+	void			Start(int nThreads = 0);
+	void			Stop();
+
+	void			Run(int count, const std::function<void(int)>& job);
+
+	int				GetThreadCount() const	{ return (int)m_Workers.size() + 1; }
+
+private:
+	CWorkerPool(const CWorkerPool& rhs);
+	CWorkerPool& operator=(const CWorkerPool& rhs);
+
+	void			WorkerMain(unsigned int generation);
+	void			Work();
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+	std::vector<std::thread>		m_Workers;
+	std::mutex						m_Mutex;
+	std::condition_variable			m_WorkReady;
+	std::condition_variable			m_WorkDone;
+	const std::function<void(int)>*	m_pJob;			// Valid while Run() runs
+	int								m_nCount;
+	std::atomic<int>				m_nNext;		// Next index to hand out
+	unsigned int					m_nGeneration;	// Bumped by every Run()
+	int								m_nBusy;		// Workers still in the job
+	bool							m_bQuit;
+};
+
+#endif // _WORKERPOOL_H_
@@ -0,0 +1,46 @@
+//-----------------------------------------------------------------------------
+// File: WorldSnapshot.h
+//
+// Desc: What the simulation hands to the renderer at the end of a step.
+//
+//-----------------------------------------------------------------------------
+
+#ifndef _WORLDSNAPSHOT_H_
+#define _WORLDSNAPSHOT_H_
+
+//-----------------------------------------------------------------------------
+// SWorldSnapshot Specific Includes
+//-----------------------------------------------------------------------------
+#include "DrawList.h"
+#include <vector>
+
+//-----------------------------------------------------------------------------
+// Main Structure Declarations
+//-----------------------------------------------------------------------------
+struct SSpritePosition
+{
+	int		x, y;
+};
+
+//-----------------------------------------------------------------------------
+// Name : SWorldSnapshot (Struct)
+// Desc : Every sprite of one simulation step with its transform, plus the
+//		numbers shown in the title bar. Once published it is only read, the
+//		simulation carries on with its own objects. Positions one step
+//		earlier are kept too, the renderer draws in between the two.
+//-----------------------------------------------------------------------------
+struct SWorldSnapshot
+{
+	std::vector<SDrawCommand>	commands;		// In recording order
+	std::vector<SSpritePosition> previous;		// Of each command, a step earlier
+	double						fTime;			// CFixedTimestep::Now() the state belongs to
+	unsigned long				nStep;			// Simulation step that made it
+	int							iScore;
+	int							iKilledChickens;
+	int							iLevel;
+	bool						bGameOver;
+
+	SWorldSnapshot() : fTime(0.0), nStep(0), iScore(0), iKilledChickens(0), iLevel(0), bGameOver(false) {}
+};
+
+#endif // _WORLDSNAPSHOT_H_
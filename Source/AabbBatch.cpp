@@ -0,0 +1,558 @@
+//-----------------------------------------------------------------------------
+// File: AabbBatch.cpp
+//
+// Desc: One box against many, overlapping or swept, with scalar, SSE2 and
+//	   AVX2 kernels selected at runtime.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAabbBatch Specific Includes
+//-----------------------------------------------------------------------------
+#include "AabbBatch.h"
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define AABB_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// GCC / Clang only emit SIMD instructions in functions that ask for them,
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__)
+#define AABB_TARGET_SSE2 __attribute__((target("sse2")))
+#define AABB_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AABB_TARGET_SSE2
+#define AABB_TARGET_AVX2
+#endif
+
+//-----------------------------------------------------------------------------
+// Shared helpers
+//-----------------------------------------------------------------------------
+static inline bool OverlapsAt(const SAabb& box, const SAabbArrays& boxes, size_t i)
+{
+	return box.fMinX <= boxes.pMaxX[i] && boxes.pMinX[i] <= box.fMaxX
+		&& box.fMinY <= boxes.pMaxY[i] && boxes.pMinY[i] <= box.fMaxY;
+}
+
+// SweepTimes() of box i, with its time of impact stored
+static inline bool SweepAt(const SAabb& fixed, const SAabbArrays& boxes, const float* pDX, const float* pDY, size_t i, float* pTime)
+{
+	SAabb box = { boxes.pMinX[i], boxes.pMinY[i], boxes.pMaxX[i], boxes.pMaxY[i] };
+	float tEnter, tExit;
+	bool bHit = SweepTimes(fixed, box, pDX[i], pDY[i], tEnter, tExit);
+	pTime[i] = tEnter > 0.0f ? tEnter : 0.0f;
+	return bHit;
+}
+
+static inline size_t BitCount(uint64_t n)
+{
+	n = n - ((n >> 1) & 0x5555555555555555ULL);
+	n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+	n = (n + (n >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (size_t)((n * 0x0101010101010101ULL) >> 56);
+}
+
+// Mostly multiples of 16 up to 128, sometimes anything else a box edge
+// could hold
+static float RandomEdge(uint32_t& seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	uint32_t r = seed >> 8;
+	switch (r & 15)
+	{
+	case 0:		return (float)(r >> 4) * 0.001f - 5000.0f;
+	case 1:		return (r & 16) ? -0.0f : 0.0f;
+	case 2:		return (r & 16) ? -INFINITY : INFINITY;
+	case 3:		return (r & 0x30) == 0x30 ? NAN : 64.0f;
+	default:	return (float)((r >> 4) % 9) * 16.0f;
+	}
+}
+
+// Mostly a few whole or half pixels either way, sometimes none, sometimes
+// anything RandomEdge() gives
+static float RandomMotion(uint32_t& seed)
+{
+	seed = seed * 1664525u + 1013904223u;
+	uint32_t r = seed >> 8;
+	switch (r & 7)
+	{
+	case 0:		return (r & 8) ? -0.0f : 0.0f;
+	case 1:		return RandomEdge(seed);
+	default:	return (float)((int)((r >> 4) % 129) - 64) * 0.5f;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Scalar reference kernel
+//-----------------------------------------------------------------------------
+static size_t Overlap_Scalar(const SAabb& box, const SAabbArrays& boxes, size_t count, uint64_t* pMask)
+{
+	size_t nHits = 0;
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		uint64_t word = 0;
+		for (size_t j = 0; j < n; j++)
+			if (OverlapsAt(box, boxes, base + j))
+				word |= 1ULL << j;
+
+		pMask[base / 64] = word;
+		nHits += BitCount(word);
+	}
+	return nHits;
+}
+
+static size_t Sweep_Scalar(const SAabb& fixed, const SAabbArrays& boxes, const float* pDX, const float* pDY,
+						   size_t count, float* pTime, uint64_t* pMask)
+{
+	size_t nHits = 0;
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		uint64_t word = 0;
+		for (size_t j = 0; j < n; j++)
+			if (SweepAt(fixed, boxes, pDX, pDY, base + j, pTime))
+				word |= 1ULL << j;
+
+		pMask[base / 64] = word;
+		nHits += BitCount(word);
+	}
+	return nHits;
+}
+
+#ifdef AABB_X86
+//-----------------------------------------------------------------------------
+// SSE2 kernel, 4 boxes per step. cmple is false for NaN, like the scalar <=.
+//-----------------------------------------------------------------------------
+AABB_TARGET_SSE2 static size_t Overlap_SSE2(const SAabb& box, const SAabbArrays& boxes, size_t count, uint64_t* pMask)
+{
+	const __m128 minX = _mm_set1_ps(box.fMinX), minY = _mm_set1_ps(box.fMinY);
+	const __m128 maxX = _mm_set1_ps(box.fMaxX), maxY = _mm_set1_ps(box.fMaxY);
+
+	size_t nHits = 0;
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		uint64_t word = 0;
+		size_t j = 0;
+		for (; j + 4 <= n; j += 4)
+		{
+			size_t i = base + j;
+			__m128 hit = _mm_and_ps(_mm_cmple_ps(minX, _mm_loadu_ps(boxes.pMaxX + i)),
+									_mm_cmple_ps(_mm_loadu_ps(boxes.pMinX + i), maxX));
+			hit = _mm_and_ps(hit, _mm_and_ps(_mm_cmple_ps(minY, _mm_loadu_ps(boxes.pMaxY + i)),
+											 _mm_cmple_ps(_mm_loadu_ps(boxes.pMinY + i), maxY)));
+			word |= (uint64_t)_mm_movemask_ps(hit) << j;
+		}
+		for (; j < n; j++)
+			if (OverlapsAt(box, boxes, base + j))
+				word |= 1ULL << j;
+
+		pMask[base / 64] = word;
+		nHits += BitCount(word);
+	}
+	return nHits;
+}
+
+//-----------------------------------------------------------------------------
+// SSE2 sweep, 4 boxes per step. minps and maxps return their second operand
+// when either is NaN, as the scalar ?: does. Lanes that do not move divide
+// by zero and have their times replaced.
+//-----------------------------------------------------------------------------
+AABB_TARGET_SSE2 static inline __m128 Select_SSE2(__m128 mask, __m128 a, __m128 b)
+{
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+AABB_TARGET_SSE2 static inline void SweepAxis_SSE2(__m128 fixedMin, __m128 fixedMax, __m128 boxMin, __m128 boxMax, __m128 d,
+												   __m128& lo, __m128& hi)
+{
+	const __m128 inf = _mm_set1_ps(INFINITY), negInf = _mm_set1_ps(-INFINITY);
+
+	__m128 still = _mm_cmpeq_ps(d, _mm_setzero_ps());
+	__m128 overlap = _mm_and_ps(_mm_cmple_ps(fixedMin, boxMax), _mm_cmple_ps(boxMin, fixedMax));
+	__m128 tA = _mm_div_ps(_mm_sub_ps(fixedMin, boxMax), d);
+	__m128 tB = _mm_div_ps(_mm_sub_ps(fixedMax, boxMin), d);
+
+	lo = Select_SSE2(still, Select_SSE2(overlap, negInf, inf), _mm_min_ps(tA, tB));
+	hi = Select_SSE2(still, Select_SSE2(overlap, inf, negInf), _mm_max_ps(tA, tB));
+}
+
+AABB_TARGET_SSE2 static size_t Sweep_SSE2(const SAabb& fixed, const SAabbArrays& boxes, const float* pDX, const float* pDY,
+										  size_t count, float* pTime, uint64_t* pMask)
+{
+	const __m128 minX = _mm_set1_ps(fixed.fMinX), minY = _mm_set1_ps(fixed.fMinY);
+	const __m128 maxX = _mm_set1_ps(fixed.fMaxX), maxY = _mm_set1_ps(fixed.fMaxY);
+	const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+
+	size_t nHits = 0;
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		uint64_t word = 0;
+		size_t j = 0;
+		for (; j + 4 <= n; j += 4)
+		{
+			size_t i = base + j;
+			__m128 loX, hiX, loY, hiY;
+			SweepAxis_SSE2(minX, maxX, _mm_loadu_ps(boxes.pMinX + i), _mm_loadu_ps(boxes.pMaxX + i), _mm_loadu_ps(pDX + i), loX, hiX);
+			SweepAxis_SSE2(minY, maxY, _mm_loadu_ps(boxes.pMinY + i), _mm_loadu_ps(boxes.pMaxY + i), _mm_loadu_ps(pDY + i), loY, hiY);
+
+			__m128 tEnter = _mm_max_ps(loX, loY), tExit = _mm_min_ps(hiX, hiY);
+			__m128 hit = _mm_and_ps(_mm_cmple_ps(tEnter, tExit), _mm_and_ps(_mm_cmple_ps(tEnter, one), _mm_cmple_ps(zero, tExit)));
+			_mm_storeu_ps(pTime + i, _mm_max_ps(tEnter, zero));
+			word |= (uint64_t)_mm_movemask_ps(hit) << j;
+		}
+		for (; j < n; j++)
+			if (SweepAt(fixed, boxes, pDX, pDY, base + j, pTime))
+				word |= 1ULL << j;
+
+		pMask[base / 64] = word;
+		nHits += BitCount(word);
+	}
+	return nHits;
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 kernel, 8 boxes per step. _CMP_LE_OQ is the ordered <= of SSE2.
+//-----------------------------------------------------------------------------
+AABB_TARGET_AVX2 static size_t Overlap_AVX2(const SAabb& box, const SAabbArrays& boxes, size_t count, uint64_t* pMask)
+{
+	const __m256 minX = _mm256_set1_ps(box.fMinX), minY = _mm256_set1_ps(box.fMinY);
+	const __m256 maxX = _mm256_set1_ps(box.fMaxX), maxY = _mm256_set1_ps(box.fMaxY);
+
+	size_t nHits = 0;
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		uint64_t word = 0;
+		size_t j = 0;
+		for (; j + 8 <= n; j += 8)
+		{
+			size_t i = base + j;
+			__m256 hit = _mm256_and_ps(_mm256_cmp_ps(minX, _mm256_loadu_ps(boxes.pMaxX + i), _CMP_LE_OQ),
+									   _mm256_cmp_ps(_mm256_loadu_ps(boxes.pMinX + i), maxX, _CMP_LE_OQ));
+			hit = _mm256_and_ps(hit, _mm256_and_ps(_mm256_cmp_ps(minY, _mm256_loadu_ps(boxes.pMaxY + i), _CMP_LE_OQ),
+												   _mm256_cmp_ps(_mm256_loadu_ps(boxes.pMinY + i), maxY, _CMP_LE_OQ)));
+			word |= (uint64_t)_mm256_movemask_ps(hit) << j;
+		}
+		for (; j < n; j++)
+			if (OverlapsAt(box, boxes, base + j))
+				word |= 1ULL << j;
+
+		pMask[base / 64] = word;
+		nHits += BitCount(word);
+	}
+	return nHits;
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 sweep, 8 boxes per step, the SSE2 one widened.
+//-----------------------------------------------------------------------------
+AABB_TARGET_AVX2 static inline void SweepAxis_AVX2(__m256 fixedMin, __m256 fixedMax, __m256 boxMin, __m256 boxMax, __m256 d,
+												   __m256& lo, __m256& hi)
+{
+	const __m256 inf = _mm256_set1_ps(INFINITY), negInf = _mm256_set1_ps(-INFINITY);
+
+	__m256 still = _mm256_cmp_ps(d, _mm256_setzero_ps(), _CMP_EQ_OQ);
+	__m256 overlap = _mm256_and_ps(_mm256_cmp_ps(fixedMin, boxMax, _CMP_LE_OQ), _mm256_cmp_ps(boxMin, fixedMax, _CMP_LE_OQ));
+	__m256 tA = _mm256_div_ps(_mm256_sub_ps(fixedMin, boxMax), d);
+	__m256 tB = _mm256_div_ps(_mm256_sub_ps(fixedMax, boxMin), d);
+
+	lo = _mm256_blendv_ps(_mm256_min_ps(tA, tB), _mm256_blendv_ps(inf, negInf, overlap), still);
+	hi = _mm256_blendv_ps(_mm256_max_ps(tA, tB), _mm256_blendv_ps(negInf, inf, overlap), still);
+}
+
+AABB_TARGET_AVX2 static size_t Sweep_AVX2(const SAabb& fixed, const SAabbArrays& boxes, const float* pDX, const float* pDY,
+										  size_t count, float* pTime, uint64_t* pMask)
+{
+	const __m256 minX = _mm256_set1_ps(fixed.fMinX), minY = _mm256_set1_ps(fixed.fMinY);
+	const __m256 maxX = _mm256_set1_ps(fixed.fMaxX), maxY = _mm256_set1_ps(fixed.fMaxY);
+	const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+
+	size_t nHits = 0;
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		uint64_t word = 0;
+		size_t j = 0;
+		for (; j + 8 <= n; j += 8)
+		{
+			size_t i = base + j;
+			__m256 loX, hiX, loY, hiY;
+			SweepAxis_AVX2(minX, maxX, _mm256_loadu_ps(boxes.pMinX + i), _mm256_loadu_ps(boxes.pMaxX + i), _mm256_loadu_ps(pDX + i), loX, hiX);
+			SweepAxis_AVX2(minY, maxY, _mm256_loadu_ps(boxes.pMinY + i), _mm256_loadu_ps(boxes.pMaxY + i), _mm256_loadu_ps(pDY + i), loY, hiY);
+
+			__m256 tEnter = _mm256_max_ps(loX, loY), tExit = _mm256_min_ps(hiX, hiY);
+			__m256 hit = _mm256_and_ps(_mm256_cmp_ps(tEnter, tExit, _CMP_LE_OQ),
+									   _mm256_and_ps(_mm256_cmp_ps(tEnter, one, _CMP_LE_OQ), _mm256_cmp_ps(zero, tExit, _CMP_LE_OQ)));
+			_mm256_storeu_ps(pTime + i, _mm256_max_ps(tEnter, zero));
+			word |= (uint64_t)_mm256_movemask_ps(hit) << j;
+		}
+		for (; j < n; j++)
+			if (SweepAt(fixed, boxes, pDX, pDY, base + j, pTime))
+				word |= 1ULL << j;
+
+		pMask[base / 64] = word;
+		nHits += BitCount(word);
+	}
+	return nHits;
+}
+#endif // AABB_X86
+
+//-----------------------------------------------------------------------------
+// Kernel tables, in EBlitLevel order
+//-----------------------------------------------------------------------------
+static const AABBBATCH_OVERLAP g_AabbKernels[BLIT_LEVEL_COUNT] =
+{
+	Overlap_Scalar,
+#ifdef AABB_X86
+	Overlap_SSE2,
+	Overlap_AVX2,
+#else
+	Overlap_Scalar,
+	Overlap_Scalar,
+#endif
+};
+
+static const AABBBATCH_SWEEP g_SweepKernels[BLIT_LEVEL_COUNT] =
+{
+	Sweep_Scalar,
+#ifdef AABB_X86
+	Sweep_SSE2,
+	Sweep_AVX2,
+#else
+	Sweep_Scalar,
+	Sweep_Scalar,
+#endif
+};
+
+//-----------------------------------------------------------------------------
+// CAabbBatch Static Variables
+//-----------------------------------------------------------------------------
+EBlitLevel			CAabbBatch::m_eLevel		= BLIT_SCALAR;
+AABBBATCH_OVERLAP	CAabbBatch::m_pfnOverlap	= Overlap_Scalar;
+AABBBATCH_SWEEP		CAabbBatch::m_pfnSweep		= Sweep_Scalar;
+
+//-----------------------------------------------------------------------------
+// Name : Init () (Static)
+// Desc : Selects the fastest kernels supported by this machine.
+//-----------------------------------------------------------------------------
+void CAabbBatch::Init()
+{
+	SetLevel(CBlitter::GetMaxLevel());
+}
+
+bool CAabbBatch::SetLevel(EBlitLevel eLevel)
+{
+	if (eLevel < BLIT_SCALAR || eLevel > CBlitter::GetMaxLevel())
+		return false;
+
+	m_eLevel		= eLevel;
+	m_pfnOverlap	= g_AabbKernels[eLevel];
+	m_pfnSweep		= g_SweepKernels[eLevel];
+	return true;
+}
+
+AABBBATCH_OVERLAP CAabbBatch::GetKernel(EBlitLevel eLevel)
+{
+	return g_AabbKernels[eLevel];
+}
+
+AABBBATCH_SWEEP CAabbBatch::GetSweepKernel(EBlitLevel eLevel)
+{
+	return g_SweepKernels[eLevel];
+}
+
+//-----------------------------------------------------------------------------
+// Name : Verify () (Static)
+// Desc : Property test over pseudo random boxes. Edges mostly come from a
+//		coarse grid so boxes often share edges and corners exactly, the
+//		rest are arbitrary floats, inverted boxes, signed zeros, infinities
+//		and NaNs. Counts and start offsets are stepped so that 1608
+//		iterations meet every count up to 200 at every offset up to 8,
+//		covering the SIMD tails and the mask word boundaries. The scalar
+//		kernel must agree with Overlaps() and every other kernel with the
+//		scalar one, mask and count, with no bits set past count. The sweep
+//		kernels are held to SweepTimes() the same way, over motions that
+//		are mostly a few pixels, sometimes none or not finite, and must
+//		give the same time of impact to the bit wherever they hit.
+//-----------------------------------------------------------------------------
+bool CAabbBatch::Verify(int iterations)
+{
+	const size_t MAX_COUNT = 200;
+	const size_t MAX_OFFSET = 8;
+	const size_t SIZE = MAX_COUNT + MAX_OFFSET;
+	const size_t WORDS = (MAX_COUNT + 63) / 64;
+
+	uint32_t seed = 12345;
+	std::vector<float> minX(SIZE), minY(SIZE), maxX(SIZE), maxY(SIZE), dX(SIZE), dY(SIZE);
+	float refTime[MAX_COUNT], outTime[MAX_COUNT];
+	uint64_t ref[WORDS], out[WORDS];
+
+	EBlitLevel eMax = CBlitter::GetMaxLevel();
+
+	for (int n = 0; n < iterations; n++)
+	{
+		for (size_t i = 0; i < SIZE; i++)
+		{
+			minX[i] = RandomEdge(seed);
+			minY[i] = RandomEdge(seed);
+			// Mostly proper boxes, some inverted ones
+			maxX[i] = (seed & 0x100) ? RandomEdge(seed) : minX[i] + (float)(seed >> 27) * 8.0f;
+			maxY[i] = (seed & 0x200) ? RandomEdge(seed) : minY[i] + (float)((seed >> 26) & 31) * 8.0f;
+			dX[i] = RandomMotion(seed);
+			dY[i] = RandomMotion(seed);
+		}
+
+		SAabb box;
+		box.fMinX = RandomEdge(seed);
+		box.fMinY = RandomEdge(seed);
+		box.fMaxX = box.fMinX + (float)(seed >> 25) * 4.0f;
+		box.fMaxY = box.fMinY + (float)((seed >> 24) & 63) * 4.0f;
+
+		size_t offset = n % MAX_OFFSET;
+		size_t count = (size_t)(n * 7) % (MAX_COUNT + 1);
+		SAabbArrays boxes = { &minX[offset], &minY[offset], &maxX[offset], &maxY[offset] };
+
+		memset(ref, 0xFF, sizeof(ref));
+		size_t nRef = Overlap_Scalar(box, boxes, count, ref);
+
+		size_t nExpected = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			SAabb other = { boxes.pMinX[i], boxes.pMinY[i], boxes.pMaxX[i], boxes.pMaxY[i] };
+			bool bHit = Overlaps(box, other);
+			if (bHit != ((ref[i / 64] >> (i % 64)) & 1))
+				return false;
+			nExpected += bHit;
+		}
+		if (nRef != nExpected || (count % 64 && ref[count / 64] >> (count % 64)))
+			return false;
+
+		for (int level = BLIT_SCALAR + 1; level <= eMax; level++)
+		{
+			memset(out, 0xFF, sizeof(out));
+			if (g_AabbKernels[level](box, boxes, count, out) != nRef)
+				return false;
+			if (memcmp(ref, out, ((count + 63) / 64) * sizeof(uint64_t)) != 0)
+				return false;
+		}
+
+		// The same boxes moving
+		memset(ref, 0xFF, sizeof(ref));
+		nRef = Sweep_Scalar(box, boxes, &dX[offset], &dY[offset], count, refTime, ref);
+
+		nExpected = 0;
+		for (size_t i = 0; i < count; i++)
+		{
+			SAabb other = { boxes.pMinX[i], boxes.pMinY[i], boxes.pMaxX[i], boxes.pMaxY[i] };
+			float tEnter, tExit;
+			bool bHit = SweepTimes(box, other, dX[offset + i], dY[offset + i], tEnter, tExit);
+			if (bHit != ((ref[i / 64] >> (i % 64)) & 1))
+				return false;
+			if (bHit && refTime[i] != (tEnter > 0.0f ? tEnter : 0.0f))
+				return false;
+			nExpected += bHit;
+		}
+		if (nRef != nExpected || (count % 64 && ref[count / 64] >> (count % 64)))
+			return false;
+
+		for (int level = BLIT_SCALAR + 1; level <= eMax; level++)
+		{
+			memset(out, 0xFF, sizeof(out));
+			if (g_SweepKernels[level](box, boxes, &dX[offset], &dY[offset], count, outTime, out) != nRef)
+				return false;
+			if (memcmp(ref, out, ((count + 63) / 64) * sizeof(uint64_t)) != 0)
+				return false;
+			for (size_t i = 0; i < count; i++)
+				if (((ref[i / 64] >> (i % 64)) & 1) && memcmp(&refTime[i], &outTime[i], sizeof(float)) != 0)
+					return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureThroughput () (Static)
+// Desc : Times one kernel over 4096 boxes scattered on an 800 x 600 field.
+//-----------------------------------------------------------------------------
+double CAabbBatch::MeasureThroughput(EBlitLevel eLevel, int iterations)
+{
+	if (eLevel < BLIT_SCALAR || eLevel > CBlitter::GetMaxLevel())
+		return 0.0;
+
+	const size_t COUNT = 4096;
+	std::vector<float> minX(COUNT), minY(COUNT), maxX(COUNT), maxY(COUNT);
+	std::vector<uint64_t> mask(COUNT / 64);
+
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < COUNT; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		minX[i] = (float)((seed >> 8) % 800);
+		seed = seed * 1664525u + 1013904223u;
+		minY[i] = (float)((seed >> 8) % 600);
+		maxX[i] = minX[i] + 13.0f;
+		maxY[i] = minY[i] + 13.0f;
+	}
+
+	SAabb box = { 350.0f, 230.0f, 450.0f, 373.0f };
+	SAabbArrays boxes = { minX.data(), minY.data(), maxX.data(), maxY.data() };
+	AABBBATCH_OVERLAP pfnOverlap = g_AabbKernels[eLevel];
+
+	size_t nHits = 0;
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int n = 0; n < iterations; n++)
+		nHits += pfnOverlap(box, boxes, COUNT, mask.data());
+	double us = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return nHits ? (double)COUNT * iterations / us : 0.0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureSweepThroughput () (Static)
+// Desc : Times one sweep kernel over the boxes of MeasureThroughput(), each
+//		moving up to 16 pixels.
+//-----------------------------------------------------------------------------
+double CAabbBatch::MeasureSweepThroughput(EBlitLevel eLevel, int iterations)
+{
+	if (eLevel < BLIT_SCALAR || eLevel > CBlitter::GetMaxLevel())
+		return 0.0;
+
+	const size_t COUNT = 4096;
+	std::vector<float> minX(COUNT), minY(COUNT), maxX(COUNT), maxY(COUNT), dX(COUNT), dY(COUNT), time(COUNT);
+	std::vector<uint64_t> mask(COUNT / 64);
+
+	uint32_t seed = 12345;
+	for (size_t i = 0; i < COUNT; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		minX[i] = (float)((seed >> 8) % 800);
+		seed = seed * 1664525u + 1013904223u;
+		minY[i] = (float)((seed >> 8) % 600);
+		maxX[i] = minX[i] + 13.0f;
+		maxY[i] = minY[i] + 13.0f;
+		dX[i] = (float)((int)((seed >> 20) % 33) - 16);
+		dY[i] = (float)((int)((seed >> 12) % 33) - 16);
+	}
+
+	SAabb box = { 350.0f, 230.0f, 450.0f, 373.0f };
+	SAabbArrays boxes = { minX.data(), minY.data(), maxX.data(), maxY.data() };
+	AABBBATCH_SWEEP pfnSweep = g_SweepKernels[eLevel];
+
+	size_t nHits = 0;
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int n = 0; n < iterations; n++)
+		nHits += pfnSweep(box, boxes, dX.data(), dY.data(), COUNT, time.data(), mask.data());
+	double us = std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+
+	return nHits ? (double)COUNT * iterations / us : 0.0;
+}
@@ -0,0 +1,717 @@
+//-----------------------------------------------------------------------------
+// File: AssetCache.cpp
+//
+// Desc: Shared, reference counted cache of decoded sprite images.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CAssetCache Specific Includes
+//-----------------------------------------------------------------------------
+#include "AssetCache.h"
+#include "Blitter.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifdef _WIN32
+#include "Main.h"
+#include "ResizeEngine.h"
+extern HINSTANCE g_hInst;
+#else
+#include <dirent.h>
+#include <strings.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Global Variable Definitions
+//-----------------------------------------------------------------------------
+CAssetCache g_AssetCache;
+
+// Default filter for scaled variants. The sprites are only ever shrunk and
+// bilinear widens to a proper area filter when minifying.
+static CBilinearFilter g_DefaultScaleFilter;
+
+//-----------------------------------------------------------------------------
+// Name : ReadLE16 () / ReadLE32 () (Static)
+// Desc : Little endian readers for the BMP headers.
+//-----------------------------------------------------------------------------
+static uint32_t ReadLE16(const uint8_t* p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8); }
+static uint32_t ReadLE32(const uint8_t* p) { return ReadLE16(p) | (ReadLE16(p + 2) << 16); }
+
+#ifndef _WIN32
+//-----------------------------------------------------------------------------
+// Name : ResolvePathCase () (Static)
+// Desc : The game refers to its data files with Windows (case insensitive)
+//		paths. Find the file that matches each path component ignoring case.
+//-----------------------------------------------------------------------------
+static std::string ResolvePathCase(const std::string& strPath)
+{
+	std::string resolved = strPath[0] == '/' ? "/" : "";
+	size_t start = strPath[0] == '/' ? 1 : 0;
+
+	while (start < strPath.size())
+	{
+		size_t end = strPath.find_first_of("/\\", start);
+		if (end == std::string::npos) end = strPath.size();
+		std::string part = strPath.substr(start, end - start);
+
+		DIR* pDir = opendir(resolved.empty() ? "." : resolved.c_str());
+		if (pDir)
+		{
+			while (dirent* pEntry = readdir(pDir))
+			{
+				if (strcasecmp(pEntry->d_name, part.c_str()) == 0)
+				{
+					part = pEntry->d_name;
+					break;
+				}
+			}
+			closedir(pDir);
+		}
+
+		resolved += part;
+		if (end < strPath.size()) resolved += '/';
+		start = end + 1;
+	}
+
+	return resolved;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : ReadBitmapFile () (Static)
+// Desc : Reads a Windows bitmap file and validates its headers. Only the
+//		uncompressed 1, 4, 8, 24 and 32 bits per pixel formats are accepted.
+//-----------------------------------------------------------------------------
+static bool ReadBitmapFile(const char* szFileName, std::vector<uint8_t>& data, int& width, int& height)
+{
+	FILE* pFile = fopen(szFileName, "rb");
+#ifndef _WIN32
+	if (!pFile) pFile = fopen(ResolvePathCase(szFileName).c_str(), "rb");
+#endif
+	if (!pFile) return false;
+
+	fseek(pFile, 0, SEEK_END);
+	long size = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	data.resize(size > 0 ? (size_t)size : 0);
+	bool ok = size > 54 && fread(&data[0], 1, data.size(), pFile) == data.size();
+	fclose(pFile);
+
+	if (!ok || data[0] != 'B' || data[1] != 'M')
+		return false;
+
+	const uint8_t* p = &data[0];
+	uint32_t offBits	= ReadLE32(p + 10);
+	uint32_t infoSize	= ReadLE32(p + 14);
+	width				= (int)ReadLE32(p + 18);
+	height				= (int)ReadLE32(p + 22);
+	uint32_t bitCount	= ReadLE16(p + 28);
+	uint32_t compression = ReadLE32(p + 30);
+
+	// BI_RGB only, BI_BITFIELDS 32 bit images use the same layout in practice
+	if (infoSize < 40 || (compression != 0 && !(compression == 3 && bitCount == 32)) || width <= 0 || height == 0)
+		return false;
+
+	return offBits < data.size();
+}
+
+//-----------------------------------------------------------------------------
+// Name : DecodeBitmapRows () (Static)
+// Desc : Converts the pixel rows of a validated bitmap file into a top-down
+//		32-bit surface. Pixels are written opaque, as 0xFFRRGGBB.
+//-----------------------------------------------------------------------------
+static void DecodeBitmapRows(const std::vector<uint8_t>& data, CFrameBuffer& image)
+{
+	const uint8_t* p = &data[0];
+	uint32_t offBits	= ReadLE32(p + 10);
+	uint32_t infoSize	= ReadLE32(p + 14);
+	int fileHeight		= (int)ReadLE32(p + 22);
+	uint32_t bitCount	= ReadLE16(p + 28);
+	uint32_t clrUsed	= ReadLE32(p + 46);
+
+	int width		= image.Width();
+	int height		= image.Height();
+	bool bTopDown	= fileHeight < 0;
+	size_t srcPitch	= ((size_t)width * bitCount + 31) / 32 * 4;
+
+	// Palette for the indexed formats
+	uint32_t palette[256];
+	memset(palette, 0, sizeof(palette));
+	if (bitCount <= 8)
+	{
+		uint32_t count = clrUsed ? clrUsed : (1u << bitCount);
+		const uint8_t* pPal = p + 14 + infoSize;
+		for (uint32_t i = 0; i < count && i < 256 && pPal + i * 4 + 3 < p + data.size(); i++)
+			palette[i] = PackPixel(pPal[i * 4 + 2], pPal[i * 4 + 1], pPal[i * 4]);
+	}
+
+	for (int y = 0; y < height; y++)
+	{
+		int srcRow = bTopDown ? y : height - 1 - y;
+		const uint8_t* pSrc = p + offBits + srcRow * srcPitch;
+		uint32_t* pDst = image.Row(y);
+
+		if (pSrc + srcPitch > p + data.size())
+		{
+			memset(pDst, 0, width * sizeof(uint32_t));
+			continue;
+		}
+
+		for (int x = 0; x < width; x++)
+		{
+			uint32_t c;
+			switch (bitCount)
+			{
+			case 1:  c = palette[(pSrc[x >> 3] >> (7 - (x & 7))) & 1]; break;
+			case 4:  c = palette[(pSrc[x >> 1] >> ((x & 1) ? 0 : 4)) & 15]; break;
+			case 8:  c = palette[pSrc[x]]; break;
+			case 24: c = PackPixel(pSrc[x * 3 + 2], pSrc[x * 3 + 1], pSrc[x * 3]); break;
+			default: c = PackPixel(pSrc[x * 4 + 2], pSrc[x * 4 + 1], pSrc[x * 4]); break;
+			}
+			pDst[x] = 0xFF000000 | c;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// CSpriteAsset Member Functions
+//-----------------------------------------------------------------------------
+CSpriteAsset::CSpriteAsset(const std::string& strPath) : m_strPath(strPath)
+{
+	static uint32_t s_nNextId = 0;
+	m_nId		= s_nNextId++;
+
+	m_iRefCount = 0;
+	m_bMasked	= false;
+	m_KeyColor	= 0;
+}
+
+CSpriteAsset::~CSpriteAsset()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : AllocImage () (Private)
+// Desc : Allocates the pixel storage.
+//-----------------------------------------------------------------------------
+bool CSpriteAsset::AllocImage(int width, int height)
+{
+	return m_Image.Create(width, height);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Load () (Private)
+// Desc : Decodes the image file named by m_strPath.
+//-----------------------------------------------------------------------------
+bool CSpriteAsset::Load()
+{
+	std::vector<uint8_t> data;
+	int width, height;
+
+	if (!ReadBitmapFile(m_strPath.c_str(), data, width, height))
+		return false;
+
+	if (!AllocImage(width, height < 0 ? -height : height))
+		return false;
+
+	DecodeBitmapRows(data, m_Image);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildColorKeyMask ()
+// Desc : Marks every pixel matching the key color as transparent. Runs once,
+//		later calls with the same key are free.
+//-----------------------------------------------------------------------------
+void CSpriteAsset::BuildColorKeyMask(uint32_t keyColor)
+{
+	keyColor &= 0x00FFFFFF;
+	if (m_bMasked)
+	{
+		assert(m_KeyColor == keyColor && "An image can only be used with one transparent color!");
+		return;
+	}
+
+	for (int y = 0; y < m_Image.Height(); y++)
+	{
+		uint32_t* pRow = m_Image.Row(y);
+		for (int x = 0; x < m_Image.Width(); x++)
+		{
+			uint32_t rgb = pRow[x] & 0x00FFFFFF;
+			pRow[x] = rgb == keyColor ? rgb : (rgb | 0xFF000000);
+		}
+	}
+
+	m_KeyColor	= keyColor;
+	m_bMasked	= true;
+	m_Spans.Build(m_Image);
+	m_HitMask.Build(m_Image);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildMask ()
+// Desc : Same as above for images that come with a separate mask bitmap,
+//		where black marks the pixels to draw.
+//-----------------------------------------------------------------------------
+void CSpriteAsset::BuildMask(const CSpriteAsset* pMask)
+{
+	if (m_bMasked || !pMask)
+		return;
+
+	assert(pMask->Width() == Width() && pMask->Height() == Height());
+
+	for (int y = 0; y < m_Image.Height(); y++)
+	{
+		uint32_t* pRow = m_Image.Row(y);
+		const uint32_t* pMaskRow = pMask->m_Image.Row(y);
+		for (int x = 0; x < m_Image.Width(); x++)
+		{
+			uint32_t rgb = pRow[x] & 0x00FFFFFF;
+			pRow[x] = (pMaskRow[x] & 0x00FFFFFF) == 0 ? (rgb | 0xFF000000) : rgb;
+		}
+	}
+
+	m_bMasked = true;
+	m_Spans.Build(m_Image);
+	m_HitMask.Build(m_Image);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildScaled () (Private)
+// Desc : Makes this asset a width x height copy of pBase. The colors are
+//		premultiplied by the mask so transparent pixels do not bleed into
+//		the edges, filtered, and the result is thresholded back into a
+//		binary mask so the span blitter can draw it.
+//-----------------------------------------------------------------------------
+bool CSpriteAsset::BuildScaled(const CSpriteAsset* pBase, int width, int height, CGenericFilter* pFilter)
+{
+	const CFrameBuffer& base = pBase->m_Image;
+
+	CFrameBuffer premul(base.Width(), base.Height());
+	if (!premul.IsValid())
+		return false;
+
+	for (int y = 0; y < base.Height(); y++)
+	{
+		const uint32_t* pSrc = base.Row(y);
+		uint32_t* pDst = premul.Row(y);
+		for (int x = 0; x < base.Width(); x++)
+			pDst[x] = (pSrc[x] >> 24) ? pSrc[x] : 0;
+	}
+
+#ifdef _WIN32
+	CResizableImage resizer;
+	resizer.SetFilter(pFilter);
+	if (!resizer.LoadFromFrameBuffer(premul))
+		return false;
+
+	resizer.Resample(width, height);
+
+	if (!resizer.CopyToFrameBuffer(m_Image))
+		return false;
+#else
+	// CResizableImage sits on the GDI image class, headless builds fall
+	// back to nearest sampling.
+	(void)pFilter;
+	if (!AllocImage(width, height))
+		return false;
+
+	CBlitter::BlitStretched(m_Image, 0, 0, width, height, premul, 0, 0, premul.Width(), premul.Height(), BLIT_OPAQUE);
+#endif
+
+	m_KeyColor = pBase->m_KeyColor;
+
+	for (int y = 0; y < m_Image.Height(); y++)
+	{
+		uint32_t* pRow = m_Image.Row(y);
+		for (int x = 0; x < m_Image.Width(); x++)
+		{
+			uint32_t c = pRow[x];
+			uint32_t a = c >> 24;
+
+			if (a < 0x80)
+			{
+				pRow[x] = m_KeyColor;
+				continue;
+			}
+
+			// Undo the premultiply on the partly covered edge pixels
+			uint32_t r = ((c >> 16) & 0xFF) * 255 / a;
+			uint32_t g = ((c >> 8) & 0xFF) * 255 / a;
+			uint32_t b = (c & 0xFF) * 255 / a;
+			pRow[x] = 0xFF000000 | ((r > 255 ? 255 : r) << 16) | ((g > 255 ? 255 : g) << 8) | (b > 255 ? 255 : b);
+		}
+	}
+
+	m_bMasked = true;
+	m_Spans.Build(m_Image);
+
+	// Not from the filtered image: hits must fall on the same pixels in
+	// every build, or recorded sessions would not replay elsewhere
+	m_HitMask.BuildScaled(pBase->m_HitMask, width, height);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DefineFrameGrid ()
+// Desc : Cuts count frames of w x h out of the image, row by row, columns
+//		per row, starting at (x, y). The frames are named after the file
+//		("explosion_0" ... ) and show up under those names in the atlas.
+//		Defining the same grid again is a no-op.
+//-----------------------------------------------------------------------------
+void CSpriteAsset::DefineFrameGrid(int x, int y, int w, int h, int count, int columns)
+{
+	if (!m_Frames.empty())
+	{
+		assert((int)m_Frames.size() == count && m_Frames[0].rc.w == w && m_Frames[0].rc.h == h &&
+			   "An image can only be cut into one frame grid!");
+		return;
+	}
+
+	// File name without folder and extension
+	size_t start = m_strPath.find_last_of("/\\");
+	start = start == std::string::npos ? 0 : start + 1;
+	size_t end = m_strPath.find_last_of('.');
+	if (end == std::string::npos || end < start) end = m_strPath.size();
+	std::string strStem = m_strPath.substr(start, end - start);
+
+	char szIndex[16];
+	for (int i = 0; i < count; i++)
+	{
+		SSpriteFrame frame;
+		snprintf(szIndex, sizeof(szIndex), "_%d", i);
+		frame.strName	= strStem + szIndex;
+		frame.rc.x		= x + (i % columns) * w;
+		frame.rc.y		= y + (i / columns) * h;
+		frame.rc.w		= w;
+		frame.rc.h		= h;
+
+		assert(frame.rc.x + w <= Width() && frame.rc.y + h <= Height());
+		m_Frames.push_back(frame);
+	}
+}
+
+int CSpriteAsset::FindFrame(const std::string& strName) const
+{
+	for (size_t i = 0; i < m_Frames.size(); i++)
+		if (m_Frames[i].strName == strName)
+			return (int)i;
+
+	return -1;
+}
+
+//-----------------------------------------------------------------------------
+// CAssetCache Member Functions
+//-----------------------------------------------------------------------------
+CAssetCache::CAssetCache()
+{
+	m_nHits			= 0;
+	m_nMisses		= 0;
+	m_pScaleFilter	= &g_DefaultScaleFilter;
+	m_bAtlasDirty	= false;
+}
+
+CAssetCache::~CAssetCache()
+{
+	for (std::map<std::string, CSpriteAsset*>::iterator it = m_Assets.begin(); it != m_Assets.end(); ++it)
+		delete it->second;
+	m_Assets.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : MakeKey () (Private, Static)
+// Desc : Builds the lookup key of a file. Paths are case insensitive on
+//		Windows and the code mixes "data/" and "Data/", so normalise them.
+//-----------------------------------------------------------------------------
+std::string CAssetCache::MakeKey(const char* szFileName)
+{
+	std::string key(szFileName);
+	for (size_t i = 0; i < key.size(); i++)
+	{
+		if (key[i] == '\\') key[i] = '/';
+		else if (key[i] >= 'A' && key[i] <= 'Z') key[i] = key[i] - 'A' + 'a';
+	}
+	return key;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Acquire ()
+// Desc : Returns the asset for an image file, loading it on first use. The
+//		caller owns one reference and must hand it back through Release().
+//-----------------------------------------------------------------------------
+CSpriteAsset* CAssetCache::Acquire(const char* szFileName)
+{
+	std::string key = MakeKey(szFileName);
+
+	std::map<std::string, CSpriteAsset*>::iterator it = m_Assets.find(key);
+	if (it != m_Assets.end())
+	{
+		m_nHits++;
+		it->second->m_iRefCount++;
+		return it->second;
+	}
+
+	m_nMisses++;
+
+	CSpriteAsset* pAsset = new CSpriteAsset(szFileName);
+	if (!pAsset->Load())
+	{
+		delete pAsset;
+		return NULL;
+	}
+
+	m_Assets[key] = pAsset;
+	m_bAtlasDirty = true;
+	pAsset->m_iRefCount++;
+	return pAsset;
+}
+
+#ifdef _WIN32
+//-----------------------------------------------------------------------------
+// Name : Acquire ()
+// Desc : Same as above for a bitmap stored in the executable's resources.
+//-----------------------------------------------------------------------------
+CSpriteAsset* CAssetCache::Acquire(int resourceID)
+{
+	char szKey[32];
+	sprintf_s(szKey, "#%d", resourceID);
+
+	std::map<std::string, CSpriteAsset*>::iterator it = m_Assets.find(szKey);
+	if (it != m_Assets.end())
+	{
+		m_nHits++;
+		it->second->m_iRefCount++;
+		return it->second;
+	}
+
+	m_nMisses++;
+
+	HBITMAP hBitmap = LoadBitmap(g_hInst, MAKEINTRESOURCE(resourceID));
+	if (!hBitmap)
+		return NULL;
+
+	BITMAP bm;
+	GetObject(hBitmap, sizeof(BITMAP), &bm);
+
+	CSpriteAsset* pAsset = new CSpriteAsset(szKey);
+	if (!pAsset->AllocImage(bm.bmWidth, bm.bmHeight))
+	{
+		DeleteObject(hBitmap);
+		delete pAsset;
+		return NULL;
+	}
+
+	// Let GDI convert whatever format the resource has into 32-bit rows
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		= bm.bmWidth;
+	bmi.bmiHeader.biHeight		= -bm.bmHeight;
+	bmi.bmiHeader.biPlanes		= 1;
+	bmi.bmiHeader.biBitCount	= 32;
+	bmi.bmiHeader.biCompression	= BI_RGB;
+
+	std::vector<uint32_t> bits((size_t)bm.bmWidth * bm.bmHeight);
+	HDC hDC = CreateCompatibleDC(NULL);
+	GetDIBits(hDC, hBitmap, 0, bm.bmHeight, &bits[0], &bmi, DIB_RGB_COLORS);
+	DeleteDC(hDC);
+	DeleteObject(hBitmap);
+
+	// Resource bitmaps are opaque, mark them the same way the decoder does
+	CFrameBuffer& image = pAsset->m_Image;
+	for (int y = 0; y < image.Height(); y++)
+		for (int x = 0; x < image.Width(); x++)
+			image.Row(y)[x] = bits[(size_t)y * bm.bmWidth + x] | 0xFF000000;
+
+	m_Assets[szKey] = pAsset;
+	m_bAtlasDirty = true;
+	pAsset->m_iRefCount++;
+	return pAsset;
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Hands back a reference obtained from Acquire(). The asset itself
+//		stays resident until Purge().
+//-----------------------------------------------------------------------------
+void CAssetCache::Release(CSpriteAsset* pAsset)
+{
+	if (!pAsset)
+		return;
+
+	assert(pAsset->m_iRefCount > 0 && "CAssetCache::Release called too many times!");
+	pAsset->m_iRefCount--;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Preload ()
+// Desc : Decodes an image ahead of time so the first in-game use is a hit.
+//-----------------------------------------------------------------------------
+bool CAssetCache::Preload(const char* szFileName)
+{
+	CSpriteAsset* pAsset = Acquire(szFileName);
+	Release(pAsset);
+	return pAsset != NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AcquireScaled ()
+// Desc : Returns the variant of pBase resized to round(w * scaleX) by
+//		round(h * scaleY), building it on first use. Scales are keyed to a
+//		thousandth. Build the base mask first, the variant inherits it.
+//-----------------------------------------------------------------------------
+CSpriteAsset* CAssetCache::AcquireScaled(const CSpriteAsset* pBase, float scaleX, float scaleY)
+{
+	if (!pBase)
+		return NULL;
+
+	int width	= (int)floor(pBase->Width() * scaleX + 0.5f);
+	int height	= (int)floor(pBase->Height() * scaleY + 0.5f);
+	if (width <= 0 || height <= 0)
+		return NULL;
+
+	char szScale[48];
+	snprintf(szScale, sizeof(szScale), "@%dx%d", (int)floor(scaleX * 1000.0f + 0.5f), (int)floor(scaleY * 1000.0f + 0.5f));
+	std::string key = MakeKey(pBase->Path().c_str()) + szScale;
+
+	std::map<std::string, CSpriteAsset*>::iterator it = m_Assets.find(key);
+	if (it != m_Assets.end())
+	{
+		m_nHits++;
+		it->second->m_iRefCount++;
+		return it->second;
+	}
+
+	m_nMisses++;
+
+	CSpriteAsset* pAsset = new CSpriteAsset(pBase->Path() + szScale);
+	if (!pAsset->BuildScaled(pBase, width, height, m_pScaleFilter))
+	{
+		delete pAsset;
+		return NULL;
+	}
+
+	m_Assets[key] = pAsset;
+	m_bAtlasDirty = true;
+	pAsset->m_iRefCount++;
+	return pAsset;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetScaleFilter ()
+// Desc : Selects the filter used for the scaled variants built after this
+//		call, NULL restores the default bilinear one.
+//-----------------------------------------------------------------------------
+void CAssetCache::SetScaleFilter(CGenericFilter* pFilter)
+{
+	m_pScaleFilter = pFilter ? pFilter : &g_DefaultScaleFilter;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildAtlas ()
+// Desc : Packs every resident image (and its named frames) into a new atlas,
+//		then points each asset at its rectangle. Sprites only hold asset
+//		pointers, so they follow along; call it between frames.
+//-----------------------------------------------------------------------------
+bool CAssetCache::BuildAtlas()
+{
+	CTextureAtlas atlas;
+
+	std::map<std::string, CSpriteAsset*>::iterator it;
+	for (it = m_Assets.begin(); it != m_Assets.end(); ++it)
+	{
+		const CSpriteAsset* pAsset = it->second;
+		atlas.AddImage(it->first, &pAsset->m_Image);
+
+		for (size_t i = 0; i < pAsset->m_Frames.size(); i++)
+			atlas.AddSubRect(pAsset->m_Frames[i].strName, it->first, pAsset->m_Frames[i].rc);
+	}
+
+	if (!atlas.Pack())
+		return false;
+
+	for (it = m_Assets.begin(); it != m_Assets.end(); ++it)
+	{
+		const SAtlasEntry* pEntry = atlas.Find(it->first);
+		if (!pEntry)
+			continue;
+
+		CFrameBuffer& page = atlas.GetPage(pEntry->iPage);
+		it->second->m_Image.Attach(page.Row(pEntry->rc.y) + pEntry->rc.x, pEntry->rc.w, pEntry->rc.h, page.Pitch());
+	}
+
+	// The old pages (if any) are freed with the temporary
+	m_Atlas.Swap(atlas);
+	m_bAtlasDirty = false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Purge ()
+// Desc : Frees every asset nobody references any more.
+//-----------------------------------------------------------------------------
+void CAssetCache::Purge()
+{
+	for (std::map<std::string, CSpriteAsset*>::iterator it = m_Assets.begin(); it != m_Assets.end(); )
+	{
+		if (it->second->m_iRefCount == 0)
+		{
+			delete it->second;
+			m_Assets.erase(it++);
+			m_bAtlasDirty = true;
+		}
+		else
+			++it;
+	}
+
+	// Nothing points into the atlas pages any more
+	if (m_Assets.empty())
+	{
+		m_Atlas.Clear();
+		m_bAtlasDirty = false;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : LogStats ()
+// Desc : Writes the cache counters and, for every masked asset, the share of
+//		opaque pixels and how much faster the span blit draws it, to the
+//		debugger output (stderr when there is no debugger API).
+//-----------------------------------------------------------------------------
+void CAssetCache::LogStats() const
+{
+	char szLine[256];
+	std::string strLog;
+
+	snprintf(szLine, sizeof(szLine), "AssetCache: %u assets, %lu hits, %lu misses\n",
+			 (unsigned)m_Assets.size(), m_nHits, m_nMisses);
+	strLog += szLine;
+
+	for (std::map<std::string, CSpriteAsset*>::const_iterator it = m_Assets.begin(); it != m_Assets.end(); ++it)
+	{
+		const CSpriteAsset* pAsset = it->second;
+		if (!pAsset->Spans().IsValid())
+			continue;
+
+		snprintf(szLine, sizeof(szLine), "  %-36s %4dx%-4d opaque %5.1f%%  %5u spans  span blit x%.2f\n",
+				 it->first.c_str(), pAsset->Width(), pAsset->Height(),
+				 pAsset->Spans().GetOpaqueRatio() * 100.0f, (unsigned)pAsset->Spans().GetSpanCount(),
+				 CBlitter::MeasureSpanSpeedup(pAsset->Image(), pAsset->Spans()));
+		strLog += szLine;
+	}
+
+	snprintf(szLine, sizeof(szLine), "Atlas: %d pages, %.1f%% occupied\n", m_Atlas.GetPageCount(), m_Atlas.GetOccupancy() * 100.0f);
+	strLog += szLine;
+	strLog += m_Atlas.FormatRectTable();
+
+#ifdef _WIN32
+	OutputDebugStringA(strLog.c_str());
+#else
+	fputs(strLog.c_str(), stderr);
+#endif
+}
@@ -3,7 +3,10 @@
 // August 24, 2004.
 #include "BackBuffer.h"
 
+// Cleared color of the back buffer (white).
+static const uint32_t CLEAR_COLOR = 0x00FFFFFF;
 
+#ifdef _WIN32
 BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 {
 	// Save a copy of the main window handle.
@@ -21,46 +24,98 @@ BackBuffer::BackBuffer(HWND hWnd, int width, int height)
 	// with the window one.
 	mhDC = CreateCompatibleDC(hWndDC);
 	SetStretchBltMode(mhDC, COLORONCOLOR);
-	// Create the backbuffer surface bitmap that is compatible
-	// with the window device context bitmap format. That is
-	// the surface we will render onto.
-	mhSurface = CreateCompatibleBitmap(hWndDC, width, height);
+
+	// Create the backbuffer surface as a top-down 32-bit DIB section.
+	// Its bits are the framebuffer memory: the engine writes pixels
+	// directly, GDI can still draw into it through mhDC, and present
+	// is a single blit of that memory to the window.
+	BITMAPINFO bmi;
+	ZeroMemory(&bmi, sizeof(BITMAPINFO));
+	bmi.bmiHeader.biSize		= sizeof(BITMAPINFOHEADER);
+	bmi.bmiHeader.biWidth		= width;
+	bmi.bmiHeader.biHeight		= -height;
+	bmi.bmiHeader.biPlanes		= 1;
+	bmi.bmiHeader.biBitCount	= 32;
+	bmi.bmiHeader.biCompression	= BI_RGB;
+
+	void* pBits = NULL;
+	mhSurface = CreateDIBSection(hWndDC, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0);
 
 	// Done with window DC.
 	ReleaseDC(hWnd, hWndDC);
 
+	// Keep the surface selected for the lifetime of the back buffer.
+	mhOldObject = (HBITMAP)SelectObject(mhDC, mhSurface);
+
+	// 32-bit DIB rows are always DWORD aligned, so the pitch is width * 4.
+	mFrameBuffer.Attach((uint32_t*)pBits, width, height, width * (int)sizeof(uint32_t));
+
 	// At this point, the back buffer surface is uninitialized,
 	// so lets clear it to some non-zero value. Note that it
 	// needs to be non-zero. If it is zero then it will mess
 	// up our sprite blending logic.
 	reset();
 }
+#endif
 
-void BackBuffer::reset()
+BackBuffer::BackBuffer(int width, int height)
 {
-	// Select the backbuffer bitmap into the DC.
-	mhOldObject = (HBITMAP)SelectObject(mhDC, mhSurface);
+#ifdef _WIN32
+	mhWnd = NULL;
+	mhDC = NULL;
+	mhSurface = NULL;
+	mhOldObject = NULL;
+#endif
 
-	// Select a white brush.
-	HBRUSH white = (HBRUSH)GetStockObject(WHITE_BRUSH);
-	HBRUSH oldBrush = (HBRUSH)SelectObject(mhDC, white);
+	mWidth = width;
+	mHeight = height;
+
+	// Nobody else owns the memory here, so allocate our own.
+	mFrameBuffer.Create(width, height);
+
+	reset();
+}
+
+void BackBuffer::reset()
+{
+	// Make sure any pending GDI drawing has reached the bits
+	// before we touch them from the CPU.
+	flush();
 
-	// Clear the backbuffer rectangle.
-	Rectangle(mhDC, 0, 0, mWidth, mHeight);
+	// Clear the backbuffer rectangle to white.
+	mFrameBuffer.Clear(CLEAR_COLOR);
+}
 
-	// Restore the original brush.
-	SelectObject(mhDC, oldBrush);
+void BackBuffer::flush() const
+{
+#ifdef _WIN32
+	// GDI batches its drawing, make sure it has landed in the
+	// framebuffer memory before the CPU draws on top of it.
+	if (mhDC) GdiFlush();
+#endif
 }
 
 BackBuffer::~BackBuffer()
 {
-	SelectObject(mhDC, mhOldObject);
-	DeleteObject(mhSurface);
-	DeleteDC(mhDC);
+	// Detach before the DIB section that owns the bits goes away.
+	mFrameBuffer.Release();
+
+#ifdef _WIN32
+	if (mhDC)
+	{
+		SelectObject(mhDC, mhOldObject);
+		DeleteObject(mhSurface);
+		DeleteDC(mhDC);
+	}
+#endif
 }
 
 void BackBuffer::present()
 {
+#ifdef _WIN32
+	if (!mhWnd)
+		return;
+
 	// Get a handle to the device context associated with
 	// the window.
 	HDC hWndDC = GetDC(mhWnd);
@@ -71,4 +126,29 @@ void BackBuffer::present()
 
 	// Always free window DC when done.
 	ReleaseDC(mhWnd, hWndDC);
-}
\ No newline at end of file
+#endif
+	// Headless: the frame stays in the framebuffer memory.
+}
+
+void BackBuffer::present(const CDirtyRegion& region)
+{
+	if (region.IsFull())
+	{
+		present();
+		return;
+	}
+
+#ifdef _WIN32
+	if (!mhWnd || region.IsEmpty())
+		return;
+
+	HDC hWndDC = GetDC(mhWnd);
+
+	// One small blit per dirty rectangle instead of the whole surface.
+	const std::vector<SAtlasRect>& rects = region.GetRects();
+	for (size_t i = 0; i < rects.size(); i++)
+		BitBlt(hWndDC, rects[i].x, rects[i].y, rects[i].w, rects[i].h, mhDC, rects[i].x, rects[i].y, SRCCOPY);
+
+	ReleaseDC(mhWnd, hWndDC);
+#endif
+}
@@ -0,0 +1,545 @@
+//-----------------------------------------------------------------------------
+// File: Blitter.cpp
+//
+// Desc: Software blitter for CFrameBuffer surfaces, with scalar, SSE2 and
+//	   AVX2 row kernels selected at runtime from CPUID.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBlitter Specific Includes
+//-----------------------------------------------------------------------------
+#include "Blitter.h"
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#define BLIT_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// GCC / Clang only emit SIMD instructions in functions that ask for them,
+// MSVC accepts the intrinsics anywhere.
+#if defined(__GNUC__)
+#define BLIT_TARGET_SSE2 __attribute__((target("sse2")))
+#define BLIT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BLIT_TARGET_SSE2
+#define BLIT_TARGET_AVX2
+#endif
+
+//-----------------------------------------------------------------------------
+// Scalar reference kernels
+//-----------------------------------------------------------------------------
+static void CopyRow_Scalar(uint32_t* pDst, const uint32_t* pSrc, int count)
+{
+	for (int i = 0; i < count; i++)
+		pDst[i] = pSrc[i];
+}
+
+static void ColorKeyRow_Scalar(uint32_t* pDst, const uint32_t* pSrc, int count, uint32_t key)
+{
+	key &= 0x00FFFFFF;
+	for (int i = 0; i < count; i++)
+		if ((pSrc[i] & 0x00FFFFFF) != key)
+			pDst[i] = pSrc[i];
+}
+
+// (s * a + d * (255 - a)) / 255, rounded. Exact for a = 0 and a = 255, and
+// only uses 16-bit intermediates so the SIMD kernels can match it bit for bit.
+static inline uint32_t BlendChannel(uint32_t s, uint32_t d, uint32_t a)
+{
+	uint32_t t = s * a + d * (255 - a) + 128;
+	return (t + (t >> 8)) >> 8;
+}
+
+static void AlphaRow_Scalar(uint32_t* pDst, const uint32_t* pSrc, int count)
+{
+	for (int i = 0; i < count; i++)
+	{
+		uint32_t s = pSrc[i];
+		uint32_t a = s >> 24;
+
+		if (a == 0xFF)	{ pDst[i] = s; continue; }
+		if (a == 0)		continue;
+
+		uint32_t d = pDst[i];
+		pDst[i] =  BlendChannel(s & 0xFF, d & 0xFF, a)
+				| (BlendChannel((s >> 8) & 0xFF, (d >> 8) & 0xFF, a) << 8)
+				| (BlendChannel((s >> 16) & 0xFF, (d >> 16) & 0xFF, a) << 16)
+				| (BlendChannel(s >> 24, d >> 24, a) << 24);
+	}
+}
+
+#ifdef BLIT_X86
+//-----------------------------------------------------------------------------
+// SSE2 kernels, 4 pixels per step
+//-----------------------------------------------------------------------------
+BLIT_TARGET_SSE2 static void CopyRow_SSE2(uint32_t* pDst, const uint32_t* pSrc, int count)
+{
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_loadu_si128((const __m128i*)(pSrc + i)));
+	CopyRow_Scalar(pDst + i, pSrc + i, count - i);
+}
+
+BLIT_TARGET_SSE2 static void ColorKeyRow_SSE2(uint32_t* pDst, const uint32_t* pSrc, int count, uint32_t key)
+{
+	const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
+	const __m128i keyVec = _mm_set1_epi32((int)(key & 0x00FFFFFF));
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+		__m128i d = _mm_loadu_si128((const __m128i*)(pDst + i));
+		__m128i eq = _mm_cmpeq_epi32(_mm_and_si128(s, rgbMask), keyVec);
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_or_si128(_mm_and_si128(eq, d), _mm_andnot_si128(eq, s)));
+	}
+	ColorKeyRow_Scalar(pDst + i, pSrc + i, count - i, key);
+}
+
+BLIT_TARGET_SSE2 static inline __m128i Blend8_SSE2(__m128i s, __m128i d)
+{
+	const __m128i c128 = _mm_set1_epi16(128);
+	const __m128i c255 = _mm_set1_epi16(255);
+
+	__m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+	__m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(c255, a))), c128);
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+BLIT_TARGET_SSE2 static void AlphaRow_SSE2(uint32_t* pDst, const uint32_t* pSrc, int count)
+{
+	const __m128i zero = _mm_setzero_si128();
+
+	int i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i s = _mm_loadu_si128((const __m128i*)(pSrc + i));
+		__m128i d = _mm_loadu_si128((const __m128i*)(pDst + i));
+
+		__m128i lo = Blend8_SSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero));
+		__m128i hi = Blend8_SSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero));
+		_mm_storeu_si128((__m128i*)(pDst + i), _mm_packus_epi16(lo, hi));
+	}
+	AlphaRow_Scalar(pDst + i, pSrc + i, count - i);
+}
+
+//-----------------------------------------------------------------------------
+// AVX2 kernels, 8 pixels per step
+//-----------------------------------------------------------------------------
+BLIT_TARGET_AVX2 static void CopyRow_AVX2(uint32_t* pDst, const uint32_t* pSrc, int count)
+{
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_si256((__m256i*)(pDst + i), _mm256_loadu_si256((const __m256i*)(pSrc + i)));
+	CopyRow_Scalar(pDst + i, pSrc + i, count - i);
+}
+
+BLIT_TARGET_AVX2 static void ColorKeyRow_AVX2(uint32_t* pDst, const uint32_t* pSrc, int count, uint32_t key)
+{
+	const __m256i rgbMask = _mm256_set1_epi32(0x00FFFFFF);
+	const __m256i keyVec = _mm256_set1_epi32((int)(key & 0x00FFFFFF));
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i s = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(pDst + i));
+		__m256i eq = _mm256_cmpeq_epi32(_mm256_and_si256(s, rgbMask), keyVec);
+		_mm256_storeu_si256((__m256i*)(pDst + i), _mm256_blendv_epi8(s, d, eq));
+	}
+	ColorKeyRow_Scalar(pDst + i, pSrc + i, count - i, key);
+}
+
+BLIT_TARGET_AVX2 static inline __m256i Blend8_AVX2(__m256i s, __m256i d)
+{
+	const __m256i c128 = _mm256_set1_epi16(128);
+	const __m256i c255 = _mm256_set1_epi16(255);
+
+	__m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+	__m256i t = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s, a), _mm256_mullo_epi16(d, _mm256_sub_epi16(c255, a))), c128);
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+BLIT_TARGET_AVX2 static void AlphaRow_AVX2(uint32_t* pDst, const uint32_t* pSrc, int count)
+{
+	const __m256i zero = _mm256_setzero_si256();
+
+	int i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		__m256i s = _mm256_loadu_si256((const __m256i*)(pSrc + i));
+		__m256i d = _mm256_loadu_si256((const __m256i*)(pDst + i));
+
+		// unpack / pack work per 128-bit lane, so the pixel order survives
+		__m256i lo = Blend8_AVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero));
+		__m256i hi = Blend8_AVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero));
+		_mm256_storeu_si256((__m256i*)(pDst + i), _mm256_packus_epi16(lo, hi));
+	}
+	AlphaRow_Scalar(pDst + i, pSrc + i, count - i);
+}
+#endif // BLIT_X86
+
+//-----------------------------------------------------------------------------
+// Kernel tables
+//-----------------------------------------------------------------------------
+static const SBlitKernels g_BlitKernels[BLIT_LEVEL_COUNT] =
+{
+	{ "Scalar", CopyRow_Scalar, ColorKeyRow_Scalar, AlphaRow_Scalar },
+#ifdef BLIT_X86
+	{ "SSE2",	CopyRow_SSE2,	ColorKeyRow_SSE2,	AlphaRow_SSE2 },
+	{ "AVX2",	CopyRow_AVX2,	ColorKeyRow_AVX2,	AlphaRow_AVX2 },
+#else
+	{ "SSE2",	CopyRow_Scalar,	ColorKeyRow_Scalar,	AlphaRow_Scalar },
+	{ "AVX2",	CopyRow_Scalar,	ColorKeyRow_Scalar,	AlphaRow_Scalar },
+#endif
+};
+
+//-----------------------------------------------------------------------------
+// CBlitter Static Variables
+//-----------------------------------------------------------------------------
+EBlitLevel		CBlitter::m_eLevel	= BLIT_SCALAR;
+SBlitKernels	CBlitter::m_Kernels	= g_BlitKernels[BLIT_SCALAR];
+
+//-----------------------------------------------------------------------------
+// Name : GetMaxLevel () (Static)
+// Desc : Queries CPUID (and the OS support for the AVX state) for the best
+//		instruction set the kernels can use.
+//-----------------------------------------------------------------------------
+EBlitLevel CBlitter::GetMaxLevel()
+{
+#ifdef BLIT_X86
+	int regs[4] = { 0, 0, 0, 0 };
+
+#ifdef _MSC_VER
+	__cpuid(regs, 0);
+	int maxLeaf = regs[0];
+	__cpuid(regs, 1);
+#else
+	int maxLeaf = (int)__get_cpuid_max(0, NULL);
+	__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+	bool bSSE2		= (regs[3] & (1 << 26)) != 0;
+	bool bOSXSAVE	= (regs[2] & (1 << 27)) != 0;
+	bool bAVX		= (regs[2] & (1 << 28)) != 0;
+
+	if (!bSSE2)
+		return BLIT_SCALAR;
+
+	if (!bOSXSAVE || !bAVX || maxLeaf < 7)
+		return BLIT_SSE2;
+
+	// The OS must save the YMM registers on context switches
+	unsigned int xcr0Lo, xcr0Hi;
+#ifdef _MSC_VER
+	unsigned long long xcr0 = _xgetbv(0);
+	xcr0Lo = (unsigned int)xcr0;
+	xcr0Hi = (unsigned int)(xcr0 >> 32);
+#else
+	__asm__ __volatile__("xgetbv" : "=a"(xcr0Lo), "=d"(xcr0Hi) : "c"(0));
+#endif
+	(void)xcr0Hi;
+	if ((xcr0Lo & 6) != 6)
+		return BLIT_SSE2;
+
+#ifdef _MSC_VER
+	__cpuidex(regs, 7, 0);
+#else
+	__cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+
+	return (regs[1] & (1 << 5)) ? BLIT_AVX2 : BLIT_SSE2;
+#else
+	return BLIT_SCALAR;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init () (Static)
+// Desc : Selects the fastest kernels supported by this machine.
+//-----------------------------------------------------------------------------
+void CBlitter::Init()
+{
+	SetLevel(GetMaxLevel());
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetLevel () (Static)
+// Desc : Forces a kernel set, fails if the CPU cannot run it.
+//-----------------------------------------------------------------------------
+bool CBlitter::SetLevel(EBlitLevel eLevel)
+{
+	if (eLevel < BLIT_SCALAR || eLevel > GetMaxLevel())
+		return false;
+
+	m_eLevel	= eLevel;
+	m_Kernels	= g_BlitKernels[eLevel];
+	return true;
+}
+
+const SBlitKernels& CBlitter::GetKernels(EBlitLevel eLevel)
+{
+	return g_BlitKernels[eLevel];
+}
+
+//-----------------------------------------------------------------------------
+// Name : Blit () (Static)
+// Desc : Unscaled blit of a w x h source rectangle at (dx, dy).
+//-----------------------------------------------------------------------------
+void CBlitter::Blit(CFrameBuffer& dst, int dx, int dy, const CFrameBuffer& src, int sx, int sy, int w, int h, EBlitMode eMode, uint32_t key)
+{
+	// Clip against the destination edges
+	if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+	if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+	if (dx + w > dst.Width())	w = dst.Width() - dx;
+	if (dy + h > dst.Height())	h = dst.Height() - dy;
+
+	if (w <= 0 || h <= 0)
+		return;
+
+	for (int y = 0; y < h; y++)
+		BlitRow(dst.Row(dy + y) + dx, src.Row(sy + y) + sx, w, eMode, key);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BlitStretched () (Static)
+// Desc : Blits a source rectangle stretched to dw x dh with nearest sampling
+//		(what StretchBlt does in COLORONCOLOR mode). Each destination row is
+//		gathered into a small stack buffer and then run through the kernels.
+//-----------------------------------------------------------------------------
+void CBlitter::BlitStretched(CFrameBuffer& dst, int dx, int dy, int dw, int dh, const CFrameBuffer& src, int sx, int sy, int sw, int sh, EBlitMode eMode, uint32_t key)
+{
+	if (dw == sw && dh == sh)
+	{
+		Blit(dst, dx, dy, src, sx, sy, sw, sh, eMode, key);
+		return;
+	}
+
+	if (dw <= 0 || dh <= 0 || sw <= 0 || sh <= 0)
+		return;
+
+	int x0 = dx < 0 ? 0 : dx;
+	int y0 = dy < 0 ? 0 : dy;
+	int x1 = dx + dw > dst.Width() ? dst.Width() : dx + dw;
+	int y1 = dy + dh > dst.Height() ? dst.Height() : dy + dh;
+
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	// 16.16 fixed point source steps
+	uint32_t stepX = ((uint32_t)sw << 16) / (uint32_t)dw;
+	uint32_t stepY = ((uint32_t)sh << 16) / (uint32_t)dh;
+
+	const int LINE = 256;
+	uint32_t line[LINE];
+
+	for (int y = y0; y < y1; y++)
+	{
+		const uint32_t* pSrc = src.Row(sy + (int)(((uint32_t)(y - dy) * stepY) >> 16)) + sx;
+		uint32_t* pDst = dst.Row(y);
+
+		for (int x = x0; x < x1; x += LINE)
+		{
+			int count = x1 - x < LINE ? x1 - x : LINE;
+			uint32_t fx = (uint32_t)(x - dx) * stepX;
+			for (int i = 0; i < count; i++, fx += stepX)
+				line[i] = pSrc[fx >> 16];
+
+			BlitRow(pDst + x, line, count, eMode, key);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BlitSpans () (Static)
+// Desc : Unscaled blit that walks the run-length table of the source and
+//		copies each opaque run with the copy kernel. Runs are trimmed to the
+//		source rectangle and to the destination edges.
+//-----------------------------------------------------------------------------
+void CBlitter::BlitSpans(CFrameBuffer& dst, int dx, int dy, const CFrameBuffer& src, const CRleImage& spans, int sx, int sy, int w, int h)
+{
+	// Clip against the destination edges
+	if (dx < 0) { sx -= dx; w += dx; dx = 0; }
+	if (dy < 0) { sy -= dy; h += dy; dy = 0; }
+	if (dx + w > dst.Width())	w = dst.Width() - dx;
+	if (dy + h > dst.Height())	h = dst.Height() - dy;
+
+	if (w <= 0 || h <= 0 || !spans.IsValid())
+		return;
+
+	int x0 = sx, x1 = sx + w;
+
+	for (int y = 0; y < h; y++)
+	{
+		const uint32_t* pSrc = src.Row(sy + y);
+		uint32_t* pDst = dst.Row(dy + y) + dx - sx;
+
+		const SRleSpan* pEnd = spans.RowEnd(sy + y);
+		for (const SRleSpan* pSpan = spans.RowBegin(sy + y); pSpan != pEnd; ++pSpan)
+		{
+			int s = pSpan->x;
+			int e = s + pSpan->length;
+
+			if (e <= x0) continue;
+			if (s >= x1) break;
+			if (s < x0) s = x0;
+			if (e > x1) e = x1;
+
+			m_Kernels.pfnCopy(pDst + s, pSrc + s, e - s);
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Verify () (Static)
+// Desc : Runs every kernel this CPU supports over the same pseudo random
+//		rows (every length up to 67 and every start offset up to 8, so the
+//		SIMD tails are covered) and compares the result with the scalar one.
+//-----------------------------------------------------------------------------
+bool CBlitter::Verify()
+{
+	const int MAX_COUNT = 67;
+	const int MAX_OFFSET = 8;
+	const int SIZE = MAX_COUNT + MAX_OFFSET;
+	const uint32_t keys[] = { 0x00FF00FF, 0x00000000, 0x00FFFFFF };
+
+	uint32_t src[SIZE], dst[SIZE], ref[SIZE], out[SIZE];
+
+	// Mix of key colors, opaque, transparent and translucent pixels
+	uint32_t seed = 12345;
+	for (int i = 0; i < SIZE; i++)
+	{
+		seed = seed * 1664525 + 1013904223;
+		uint32_t c = seed;
+		switch ((seed >> 28) & 7)
+		{
+		case 0: c = (c & 0xFF000000) | keys[(seed >> 8) % 3]; break;
+		case 1: c |= 0xFF000000; break;
+		case 2: c &= 0x00FFFFFF; break;
+		}
+		src[i] = c;
+
+		seed = seed * 1664525 + 1013904223;
+		dst[i] = seed;
+	}
+
+	EBlitLevel eMax = GetMaxLevel();
+	const SBlitKernels& scalar = g_BlitKernels[BLIT_SCALAR];
+
+	for (int level = BLIT_SCALAR + 1; level <= eMax; level++)
+	{
+		const SBlitKernels& k = g_BlitKernels[level];
+
+		for (int mode = 0; mode < BLIT_MODE_COUNT; mode++)
+		for (int key = 0; key < (mode == BLIT_COLORKEY ? 3 : 1); key++)
+		for (int offset = 0; offset < MAX_OFFSET; offset++)
+		for (int count = 0; count <= MAX_COUNT; count++)
+		{
+			memcpy(ref, dst, sizeof(dst));
+			memcpy(out, dst, sizeof(dst));
+
+			switch (mode)
+			{
+			case BLIT_OPAQUE:
+				scalar.pfnCopy(ref + offset, src + offset, count);
+				k.pfnCopy(out + offset, src + offset, count);
+				break;
+			case BLIT_COLORKEY:
+				scalar.pfnColorKey(ref + offset, src + offset, count, keys[key]);
+				k.pfnColorKey(out + offset, src + offset, count, keys[key]);
+				break;
+			default:
+				scalar.pfnAlpha(ref + offset, src + offset, count);
+				k.pfnAlpha(out + offset, src + offset, count);
+				break;
+			}
+
+			if (memcmp(ref, out, sizeof(ref)) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureThroughput () (Static)
+// Desc : Times one kernel over a 512 x 512 block (about one framebuffer
+//		worth of rows) and returns megapixels per second, or 0 if the CPU
+//		cannot run that level.
+//-----------------------------------------------------------------------------
+double CBlitter::MeasureThroughput(EBlitLevel eLevel, EBlitMode eMode, int iterations)
+{
+	if (eLevel > GetMaxLevel())
+		return 0.0;
+
+	const int SIZE = 512;
+	CFrameBuffer src(SIZE, SIZE), dst(SIZE, SIZE);
+
+	uint32_t seed = 1;
+	for (int y = 0; y < SIZE; y++)
+		for (int x = 0; x < SIZE; x++)
+		{
+			seed = seed * 1664525 + 1013904223;
+			src.Row(y)[x] = (seed & 8) ? 0x00FF00FF : seed;
+		}
+
+	const SBlitKernels& k = g_BlitKernels[eLevel];
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+	for (int it = 0; it < iterations; it++)
+		for (int y = 0; y < SIZE; y++)
+		{
+			switch (eMode)
+			{
+			case BLIT_OPAQUE:	k.pfnCopy(dst.Row(y), src.Row(y), SIZE); break;
+			case BLIT_COLORKEY:	k.pfnColorKey(dst.Row(y), src.Row(y), SIZE, 0x00FF00FF); break;
+			default:			k.pfnAlpha(dst.Row(y), src.Row(y), SIZE); break;
+			}
+		}
+
+	double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+	if (seconds <= 0.0)
+		return 0.0;
+
+	return (double)SIZE * SIZE * iterations / seconds / 1e6;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureSpanSpeedup () (Static)
+// Desc : Draws the image the same number of times with the alpha kernel and
+//		with its span table and returns the ratio of the two times.
+//-----------------------------------------------------------------------------
+double CBlitter::MeasureSpanSpeedup(const CFrameBuffer& src, const CRleImage& spans, int iterations)
+{
+	if (!src.IsValid() || !spans.IsValid())
+		return 0.0;
+
+	CFrameBuffer dst(src.Width(), src.Height());
+	int w = src.Width(), h = src.Height();
+
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	for (int it = 0; it < iterations; it++)
+		Blit(dst, 0, 0, src, 0, 0, w, h, BLIT_ALPHA);
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for (int it = 0; it < iterations; it++)
+		BlitSpans(dst, 0, 0, src, spans, 0, 0, w, h);
+
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+	double keyed = std::chrono::duration<double>(t1 - t0).count();
+	double runs  = std::chrono::duration<double>(t2 - t1).count();
+	return runs > 0.0 ? keyed / runs : 0.0;
+}
@@ -1,22 +1,13 @@
 #include "CBullet.h"
-#include "CGameApp.h"
 
-extern CGameApp g_App;
 CBullet::CBullet()
 {
 
 }
 
-CBullet::CBullet(const BackBuffer* pBackBuffer)
+CBullet::CBullet(Vec2 speed)
 {
-	m_pSprite = new Sprite("data/bulletandmask.bmp", RGB(0xff, 0x00, 0xff));
-	m_pSprite->setBackBuffer(pBackBuffer);
-}
-
-CBullet::CBullet(const BackBuffer* pBackBuffer, Vec2 speed)
-{
-	m_pSprite = new Sprite("data/bulletandmask.bmp", RGB(0xff, 0x00, 0xff));
-	m_pSprite->setBackBuffer(pBackBuffer);
+	m_pSprite = new Sprite("data/bulletandmask.bmp", PackPixel(0xff, 0x00, 0xff));
 	m_pSpeed = speed;
 }
 
@@ -25,9 +16,9 @@ CBullet::~CBullet()
 	delete m_pSprite;
 }
 
-void CBullet::Draw()
+void CBullet::Draw(CDrawList& drawList)
 {
-	m_pSprite->draw();
+	m_pSprite->draw(drawList, DRAWLAYER_BULLETS);
 }
 
 void CBullet::Tick(float delta)
@@ -41,56 +32,41 @@ void CBullet::SetPosition(float x, float y)
 	m_pSprite->mPosition.y = y;
 }
 
-bool CBullet::IsOutside()
+//-----------------------------------------------------------------------------
+// Name : IsOutside ()
+// Desc : True once nothing of the bullet as drawn is left on the field.
+//-----------------------------------------------------------------------------
+bool CBullet::IsOutside(int width, int height)
 {
-	int width, height;
-	g_App.GetWindowSize(width, height);
-	Vec2 scale = m_pSprite->getScale();
-	double pos = m_pSprite->mPosition.x - m_pSprite->width() * scale.x / 2;
-	if (pos < 0)
-		return true;
-
-	pos = m_pSprite->mPosition.x + m_pSprite->width() * scale.x / 2;
-	if (pos > (width + m_pSprite->width()))
-		return true;
-
-	pos = m_pSprite->mPosition.y - m_pSprite->height() * scale.y / 2;
-	if (pos < 0)
-		return true;
-
-	pos = m_pSprite->mPosition.y + m_pSprite->height() * scale.y / 2;
-	if (pos > (height + m_pSprite->width()))
-		return true;
-
-	return false;
+	SAtlasRect rc = m_pSprite->drawnRect();
+	return rc.x + rc.w <= 0 || rc.x >= width || rc.y + rc.h <= 0 || rc.y >= height;
 }
 
+//-----------------------------------------------------------------------------
+// Name : Intersects ()
+// Desc : Both sprites where they are drawn, mPosition being their center,
+//		and only the pixels they draw.
+//-----------------------------------------------------------------------------
 bool CBullet::Intersects(Sprite* sprite)
 {
-	Vec2 pPosition = sprite->mPosition;
-	Vec2 pSize = Vec2(sprite->width(), sprite->height());
-
-	Vec2& position = m_pSprite->mPosition;
-	Vec2 scale = m_pSprite->getScale();
-
-	CBoundingBox box(m_pSprite->mPosition, m_pSprite->mPosition + Vec2(m_pSprite->width() * scale.x, m_pSprite->height() * scale.y));
-	CBoundingBox chickenBox(pPosition, pPosition + pSize);
-
-	if (chickenBox.Intersects(box))
-		return true;
-	return false;
+	const CSpriteAsset* pImage = m_pSprite->drawnImage();
+	const CSpriteAsset* pOther = sprite->drawnImage();
+	if (!pImage || !pOther)
+		return false;
+
+	SAtlasRect rc = m_pSprite->drawnRect();
+	SAtlasRect rcOther = sprite->drawnRect();
+	return CHitMask::Overlap(pImage->HitMask(), rc.x, rc.y, pOther->HitMask(), rcOther.x, rcOther.y);
 }
 
-CChickenBullet::CChickenBullet(const BackBuffer* pBackBuffer, Vec2 speed)
+CChickenBullet::CChickenBullet(Vec2 speed)
 {
-	m_pSprite = new Sprite("data/chickenbulletandmask.bmp", RGB(0xff, 0x00, 0xff));
-	m_pSprite->setBackBuffer(pBackBuffer);
+	m_pSprite = new Sprite("data/chickenbulletandmask.bmp", PackPixel(0xff, 0x00, 0xff));
 	m_pSpeed = speed;
 }
 
-BigBossBullet::BigBossBullet(const BackBuffer* pBackBuffer, Vec2 speed)
+BigBossBullet::BigBossBullet(Vec2 speed)
 {
-	m_pSprite = new Sprite("data/BulletBigBossAndMask.bmp", RGB(0xff, 0x00, 0xff));
-	m_pSprite->setBackBuffer(pBackBuffer);
+	m_pSprite = new Sprite("data/BulletBigBossAndMask.bmp", PackPixel(0xff, 0x00, 0xff));
 	m_pSpeed = speed;
 }
@@ -9,10 +9,17 @@
 // CGameApp Specific Includes
 //-----------------------------------------------------------------------------
 #include "CGameApp.h"
+#include "Blitter.h"
+#include "AabbBatch.h"
+#include <algorithm>
+#include <chrono>
 
 
 extern HINSTANCE g_hInst;
 
+// Further than this in one step is a jump, not movement
+static const int INTERPOLATE_MAX_DISTANCE = 32;
+
 //-----------------------------------------------------------------------------
 // CGameApp Member Functions
 //-----------------------------------------------------------------------------
@@ -27,13 +34,18 @@ CGameApp::CGameApp()
 	m_hIcon			= NULL;
 	m_hMenu			= NULL;
 	m_pBBuffer		= NULL;
-	m_pPlayer		= NULL;
-	m_iScore		= 0;
-	m_iKilledChickens = 0;
 	m_iLastScore	= 0;
 	m_LastFrameRate = 0;
-	m_iLevel = 0;
-	m_fBackgroundOffset = 0.0f;
+	m_pBackground	= NULL;
+	m_iBackgroundRow = 0;
+	m_nInputDirection = 0;
+	m_nFireRequests	= 0;
+	m_iFieldWidth	= 0;
+	m_iFieldHeight	= 0;
+	m_nPendingSounds = 0;
+	m_bSimQuit		= false;
+	m_bGameOver		= false;
+	m_bFullRedraw	= true;
 }
 
 //-----------------------------------------------------------------------------
@@ -63,13 +75,56 @@ bool CGameApp::InitInstance( LPCTSTR lpCmdLine, int iCmdShow )
 		return false; 
 	}
 
-	// Set up all required game states
-	SetupGameState();
+	// From here on the world belongs to the simulation thread
+	StartSimulation();
 
 	// Success!
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// Name : RunReplay () (Static)
+// Desc : Steps a world through a log at full speed, nothing drawn, and
+//		shows how it went: the step count and rate, and where the state
+//		first stopped matching the recording if it did. A log that played
+//		through is also seeked in, to time reaching a step from its
+//		keyframes.
+//-----------------------------------------------------------------------------
+int CGameApp::RunReplay( LPCTSTR lpFileName )
+{
+	CBlitter::Init();
+	CAabbBatch::Init();
+
+	CReplayReader reader;
+	SReplayResult result;
+	if (!reader.Open(lpFileName) || !reader.Play(result))
+	{
+		MessageBox( 0, _T("Failed to load the replay or the game data."), _T("Replay"), MB_OK | MB_ICONSTOP );
+		return 1;
+	}
+
+	double fRate = result.fSeconds > 0.0 ? result.nSteps / result.fSeconds : 0.0;
+
+	char szText[384];
+	if (result.nDivergedStep)
+		sprintf_s(szText, "DIVERGED after step %lu, by step %lu (state hashes every %u steps).\n%lu steps in %.3f s, %.0f steps/s.\n",
+				  result.nLastMatchStep, result.nDivergedStep, reader.GetHeader().nHashInterval, result.nSteps, result.fSeconds, fRate);
+	else
+	{
+		int n = sprintf_s(szText, "Identical: %lu steps, %lu state hashes matched, score %d%s.\n%.3f s, %.0f steps/s.\n",
+						  result.nSteps, result.nHashes, result.iScore, result.bGameOver ? ", game over" : "", result.fSeconds, fRate);
+
+		double msMean, msMax;
+		if (reader.MeasureSeek(16, msMean, msMax))
+			sprintf_s(szText + n, sizeof(szText) - n, "Seek: %.2f ms mean, %.2f ms worst over 16 steps (%u keyframes, every %u steps).\n",
+					  msMean, msMax, (unsigned)reader.GetKeyframeCount(), reader.GetHeader().nKeyframeInterval);
+	}
+
+	OutputDebugStringA(szText);
+	MessageBox( 0, szText, _T("Replay"), MB_OK | (result.nDivergedStep ? MB_ICONEXCLAMATION : MB_ICONINFORMATION) );
+	return result.nDivergedStep ? 2 : 0;
+}
+
 //-----------------------------------------------------------------------------
 // Name : CreateDisplay ()
 // Desc : Create the display windows, devices etc, ready for rendering.
@@ -157,6 +212,9 @@ int CGameApp::BeginGame()
 //-----------------------------------------------------------------------------
 bool CGameApp::ShutDown()
 {
+	// No more frames, the objects are about to go
+	m_bActive = false;
+
 	// Release any previously built objects
 	ReleaseObjects ( );
 	
@@ -173,16 +231,6 @@ bool CGameApp::ShutDown()
 	return true;
 }
 
-void CGameApp::GetWindowSize(int& width, int& height)
-{
-	RECT rect;
-	if (GetWindowRect(m_hWnd, &rect))
-	{
-		width = rect.right - rect.left - 16;
-		height = rect.bottom - rect.top - 36;
-	}
-}
-
 //-----------------------------------------------------------------------------
 // Name : StaticWndProc () (Static Callback)
 // Desc : This is the main messge pump for ALL display devices, it captures
@@ -246,12 +294,22 @@ LRESULT CGameApp::DisplayWndProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			// Store new viewport sizes
 			m_nViewWidth = LOWORD(lParam);
 			m_nViewHeight = HIWORD(lParam);
+			m_iFieldWidth = m_nViewWidth;
+			m_iFieldHeight = m_nViewHeight;
 
+			// Whatever the window showed is gone
+			m_bFullRedraw = true;
 
 		} // End if !Minimized
 
 		break;
 
+	case WM_PAINT:
+		// Part of the window was uncovered, the next frame presents all of it
+		ValidateRect(hWnd, NULL);
+		m_bFullRedraw = true;
+		break;
+
 	case WM_LBUTTONDOWN:
 		// Capture the mouse
 		SetCapture(m_hWnd);
@@ -270,56 +328,31 @@ LRESULT CGameApp::DisplayWndProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 			PostQuitMessage(0);
 			break;
 		case VK_SPACE:
-		{
-			if (m_pPlayer->IsExploding()) break;
-			CBullet* bullet = m_pPlayer->CreateBullet(m_pBBuffer);
-			m_bullets.push_back(bullet);
+			// The simulation thread fires on its next step
+			m_nFireRequests++;
 			break;
-		}
-		case VK_RETURN:
-			SetTimer(m_hWnd, 4, 2500, NULL);
+		case 'B':
+			// A still background leaves only the sprites to redraw
+			m_Background.SetScrolling(!m_Background.IsScrolling());
 			break;
-
-		}
-
-	case WM_TIMER:
-		switch (wParam)
-		{
-		case 1:
-			if (!m_pPlayer->AdvanceExplosion())
-				KillTimer(m_hWnd, 1);
-
-		case 2:
-			if (m_pChicken.size() < 0)
-			{
-				float pos = -100.0f;
-				if (rand() % 100 < 51) pos += 100.0f;
-				CChicken* m_chicken = new CChicken(m_pBBuffer, Vec2(pos, 100.0f), Vec2(FRand(0.1, 1.0), 0.0f));
-				float chickenScale = 0.5f; // Adjust as needed
-				m_chicken->SetScale(chickenScale, chickenScale);
-				m_pChicken.push_back(m_chicken);
-
-			}
+#ifdef _DEBUG
+		case 'T':
+			LogTileScaling();
 			break;
-		
+		case 'U':
+			LogBulletUpdate();
+			break;
+		case 'G':
+			LogBroadphase();
+			break;
+		case 'D':
+			LogSpriteDraws();
+			break;
+#endif
 
-	case 3:
-		if (m_pHealth.empty()  && m_iLevel % 2 == 0)
-		{
-			CHealth* m_health = new CHealth(m_pBBuffer, Vec2(FRand(0, 860), FRand(0, 860)));
-			m_pHealth.push_back(m_health);
 		}
 		break;
 
-	
-
-	
-
-				 
-	}
-
-			break;
-
 		case WM_COMMAND:
 			break;
 
@@ -337,36 +370,54 @@ LRESULT CGameApp::DisplayWndProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM
 //-----------------------------------------------------------------------------
 bool CGameApp::BuildObjects()
 {
+	// Pick the fastest blit kernels this CPU supports; in debug builds make
+	// sure they all agree with the scalar reference first.
+	CBlitter::Init();
+	assert(CBlitter::Verify() && "SIMD blit kernels differ from the scalar reference!");
+	CAabbBatch::Init();
+	assert(CAabbBatch::Verify() && "SIMD box kernels differ from the scalar reference!");
+
+	// One render thread per core, the message loop thread being one of them
+	m_RenderPool.Start();
+
+	// Every image spawned during play is decoded up front, so firing
+	// and new waves never go to disk.
+	static const char* szPreload[] =
+	{
+		"data/planeimgandmask.bmp", "data/explosion.bmp", "data/explosionmask.bmp",
+		"data/Heart.bmp", "data/Health.bmp", "data/ChickenEnemy.bmp", "data/BigBossImgAndMask.bmp",
+		"data/bulletandmask.bmp", "data/chickenbulletandmask.bmp", "data/BulletBigBossAndMask.bmp"
+	};
+
+	for (int i = 0; i < sizeof(szPreload) / sizeof(szPreload[0]); ++i)
+		if (!g_AssetCache.Preload(szPreload[i])) return false;
+
 	m_pBBuffer = new BackBuffer(m_hWnd, m_nViewWidth, m_nViewHeight);
-	m_pPlayer = new CPlayer(m_pBBuffer);
-	m_pPlayer->Init(m_pBBuffer);
-	CChicken* m_chicken = new CChicken(m_pBBuffer, { 600, 100 }, { 1.0f, 0.0f });
-	float chickenScale = 0.5f; // Adjust as needed
-	m_chicken->SetScale(chickenScale, chickenScale);
-	m_pChicken.push_back(m_chicken);
-	
 
-	CHealth* m_health = new CHealth(m_pBBuffer);
-	m_health->SetPosition(300, 300);
-	m_pHealth.push_back(m_health);
+	// The player, the first wave and the rest of the starting state, from
+	// a new seed each run. The session is recorded with it; a replay log
+	// that cannot be written does not stop the game.
+	uint64_t nSeed = (uint64_t)std::chrono::high_resolution_clock::now().time_since_epoch().count();
+	if (!m_World.Init(nSeed))
+		return false;
+	m_Recorder.Open(REPLAY_SESSION_FILE, m_World);
+
+	// Kept in memory, dirty rectangles are restored from it every frame
+	m_pBackground = g_AssetCache.Acquire("data/BackgroundBig.bmp");
+	if (!m_pBackground)
+		return false;
 
+	m_Background.SetImage(&m_pBackground->Image());
 
-	if (!m_imgBackground.LoadBitmapFromFile("data/BackgroundBig.bmp", GetDC(m_hWnd)))
+	// All the sprite art (masks, scaled variants and the explosion frames
+	// are built by now) goes into shared atlas pages.
+	if (!g_AssetCache.BuildAtlas())
 		return false;
 
 	// Success!
 	return true;
 }
 
-//-----------------------------------------------------------------------------
-// Name : SetupGameState ()
-// Desc : Sets up all the initial states required by the game.
-//-----------------------------------------------------------------------------
-void CGameApp::SetupGameState()
-{
-	m_pPlayer->Position() = Vec2(100, 400);
-}
-
 //-----------------------------------------------------------------------------
 // Name : ReleaseObjects ()
 // Desc : Releases our objects and their associated memory so that we can
@@ -374,12 +425,40 @@ void CGameApp::SetupGameState()
 //-----------------------------------------------------------------------------
 void CGameApp::ReleaseObjects( )
 {
-	if(m_pPlayer != NULL)
+	// Nothing may touch the objects while they go away
+	StopSimulation();
+	m_Recorder.Close();
+
+	m_World.Release();
+
+#ifdef _DEBUG
+	// Every image used this run has its mask and spans built by now
+	g_AssetCache.LogStats();
+
+	// How full the bullet pools got
+	char szLine[128];
+	sprintf_s(szLine, "Bullet pools: player peak %u of %u (%lu refused), enemy peak %u of %u (%lu refused)\n",
+			  (unsigned)m_World.GetBullets().GetPeak(), (unsigned)m_World.GetBullets().GetCapacity(), m_World.GetBullets().GetExhaustedCount(),
+			  (unsigned)m_World.GetEnemyBullets().GetPeak(), (unsigned)m_World.GetEnemyBullets().GetCapacity(), m_World.GetEnemyBullets().GetExhaustedCount());
+	OutputDebugStringA(szLine);
+
+	sprintf_s(szLine, "Arenas: frame peak %u bytes, step peak %u bytes\n",
+			  (unsigned)m_FrameArena.GetPeak(), (unsigned)m_World.GetStepArena().GetPeak());
+	OutputDebugStringA(szLine);
+#endif
+
+	if (m_pBackground != NULL)
 	{
-		delete m_pPlayer;
-		m_pPlayer = NULL;
+		m_Background.SetImage(NULL);
+		g_AssetCache.Release(m_pBackground);
+		m_pBackground = NULL;
 	}
 
+	// Nothing references the images any more
+	g_AssetCache.Purge();
+
+
+	m_RenderPool.Stop();
 
 	if(m_pBBuffer != NULL)
 	{
@@ -394,167 +473,192 @@ void CGameApp::ReleaseObjects( )
 //-----------------------------------------------------------------------------
 void CGameApp::FrameAdvance()
 {
-	static TCHAR FrameRate[ 50 ];
-	static TCHAR TitleBuffer[ 255 ];
-
 	// Advance the timer
 	m_Timer.Tick(0.0f);
 
 	// Skip if app is inactive
 	if ( !m_bActive ) return;
-	
+
+	// Latest complete step of the simulation thread, if there is a new one
+	m_Snapshots.Acquire();
+	const SWorldSnapshot& snapshot = m_Snapshots.GetReadBuffer();
+
+	if (snapshot.bGameOver)
+	{
+		ShutDown();
+		return;
+	}
+
 	// Get / Display the framerate
-	if (m_LastFrameRate != m_Timer.GetFrameRate() || m_iLastScore != m_iScore)
+	if (m_LastFrameRate != m_Timer.GetFrameRate() || m_iLastScore != snapshot.iScore)
 	{
+		TCHAR* FrameRate = (TCHAR*)m_FrameArena.Allocate(50 * sizeof(TCHAR));
+		TCHAR* TitleBuffer = (TCHAR*)m_FrameArena.Allocate(255 * sizeof(TCHAR));
+
 		m_LastFrameRate = m_Timer.GetFrameRate(FrameRate, 50);
-		m_iLastScore = m_iScore;
-		sprintf_s(TitleBuffer, _T("Game : %s | Score : %i | Kills : %i | Level: %i"), FrameRate, m_iLastScore,m_iKilledChickens,m_iLevel);
+		m_iLastScore = snapshot.iScore;
+		sprintf_s(TitleBuffer, 255, _T("Game : %s | Score : %i | Kills : %i | Level: %i | Draws: %u Batches: %u"), FrameRate, m_iLastScore,snapshot.iKilledChickens,snapshot.iLevel,
+				  m_DrawList.GetDrawCount(), m_DrawList.GetBatchCount());
 		SetWindowText(m_hWnd, TitleBuffer);
 	} // End if Frame Rate Altered
 
-	if (m_pChicken.empty() && m_iLevel!=5) {
-		for (int i = 0; i < 4; ++i) {
-			float pos = 100.0f + i * 200.0f; // Adjust the spacing between chickens as needed
-			CChicken* m_chicken = new CChicken(m_pBBuffer, { pos, 100.0f }, { 1.0f, 0.0f });
-			float chickenScale = 0.5f; // Adjust as needed
-			m_chicken->SetScale(chickenScale, chickenScale);
-			m_pChicken.push_back(m_chicken);
-			
-		}
-	}
+	// Poll & Process input devices
+	ProcessInput();
+
+	// Sounds of the steps since the last frame
+	PlaySounds(m_nPendingSounds.exchange(0));
 
+	// Animate the game objects
+	AnimateObjects();
+
+	// Drawing the game objects
+	DrawObjects(snapshot);
+
+	// Everything this frame allocated from the arena is done with
+	m_FrameArena.Reset();
+}
+
+//-----------------------------------------------------------------------------
+// Name : StartSimulation () (Private)
+// Desc : Publishes the starting state and starts the simulation thread.
+//		The system timer is set to 1 ms while it runs, so its sleeps
+//		between steps end when the next step is due.
+//-----------------------------------------------------------------------------
+void CGameApp::StartSimulation()
+{
+	m_bSimQuit = false;
+	m_bGameOver = false;
+	m_nPendingSounds = 0;
+
+	m_PrevCommands.clear();
+	RecordSnapshot(CFixedTimestep::Now());
+	m_Snapshots.Publish();
+
+	timeBeginPeriod(1);
+
+	m_SimClock.Reset();
+	m_SimThread = std::thread(&CGameApp::SimulationMain, this);
+}
 
-	if (m_iLevel % 2 == 0 && m_pHealth.empty())
+void CGameApp::StopSimulation()
+{
+	m_bSimQuit = true;
+	if (m_SimThread.joinable())
 	{
-		CHealth* m_health = new CHealth(m_pBBuffer, Vec2(FRand(0, 860), FRand(0, 860)));
-		m_pHealth.push_back(m_health);
+		m_SimThread.join();
+		timeEndPeriod(1);
 	}
-	for (auto it = m_bullets.begin(); it != m_bullets.end(); )
+}
+
+//-----------------------------------------------------------------------------
+// Name : SimulationMain () (Private)
+// Desc : Body of the simulation thread. Runs as many fixed steps as real
+//		time calls for (up to the cap), each with the input of the moment,
+//		then publishes the result while the renderer draws the one before,
+//		and sleeps until the next step is due.
+//-----------------------------------------------------------------------------
+void CGameApp::SimulationMain()
+{
+	double fLastTime = CFixedTimestep::Now();
+
+	while (!m_bSimQuit && !m_bGameOver)
 	{
-		CBullet* bullet = *it;
-		bullet->Tick(0.0f);
-		bool collided = false;
+		double fNow = CFixedTimestep::Now();
+		int nSteps = m_SimClock.Advance(fNow - fLastTime);
+		fLastTime = fNow;
 
-		if (bullet->GetType() == 0) { // Regular bullet
-			// Check for collision with chickens
-			for (auto jt = m_pChicken.begin(); jt != m_pChicken.end(); ++jt)
-			{
-				if (bullet->Intersects((*jt)->m_pSprite) )
-				{
-					delete* jt;
-					jt = m_pChicken.erase(jt);
-					m_iScore += 100;
-					m_iKilledChickens++;
-					collided = true;
-					break;
-				}
-			}
-			for (auto jt = m_pBigBoss.begin(); jt != m_pBigBoss.end(); ++jt)
-			{
-				if (bullet->Intersects((*jt)->m_pSprite))
-				{
-					delete* jt;
-					jt = m_pBigBoss.erase(jt);
-					m_iScore += 500;
-					m_iKilledChickens++;
-					collided = true;
-					break;
-				}
-			}
+		if (nSteps == 0)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>(m_SimClock.GetStep() - m_SimClock.GetRemainder()));
+			continue;
 		}
-		else { // Chicken bullet
-			// Check for collision with player
-			if (m_pPlayer->Intersects(bullet->m_pSprite)  && !m_pPlayer->IsExploding())
-			{
-				SetTimer(m_hWnd, 1, 50, NULL);
-				m_pPlayer->Explode();
-				m_pPlayer->Position() = Vec2(100, 400);
-				m_pPlayer->Velocity() = Vec2(0, 0);
-				collided = true;
-			}
-			if (m_pPlayer->IntersectsBoss(bullet->m_pSprite) && !m_pPlayer->IsExploding())
+
+		{
+			// Sprites made by a step may add images to the cache
+			std::lock_guard<std::mutex> lock(g_AssetCache.GetLock());
+
+			for (int i = 0; i < nSteps && !m_World.IsGameOver(); i++)
 			{
-				SetTimer(m_hWnd, 1, 50, NULL);
-				m_pPlayer->Explode();
-				m_pPlayer->Position() = Vec2(100, 400);
-				m_pPlayer->Velocity() = Vec2(0, 0);
-				collided = true;
+				if (i == nSteps - 1)
+					RecordPrevious();
+
+				SGameInput input;
+				input.nDirection	= m_nInputDirection;
+				input.nFire			= m_nFireRequests.exchange(0);
+				input.iWidth		= m_iFieldWidth;
+				input.iHeight		= m_iFieldHeight;
+				m_World.Step(input);
+				m_Recorder.Write(input, m_World);
 			}
-		}
 
+			m_nPendingSounds |= m_World.TakeSounds();
 
-		if (bullet->IsOutside() || collided)
-		{
-			delete bullet;
-			it = m_bullets.erase(it);
-		}
-		else
-		{
-			++it;
+			// Shutting down is up to the render thread, it owns the window
+			m_bGameOver = m_World.IsGameOver();
+
+			// The state is the time still owed behind now
+			RecordSnapshot(fNow - m_SimClock.GetRemainder());
 		}
-	}
 
+		m_Snapshots.Publish();
+	}
+}
 
-	for (auto it = m_pChicken.begin(); it != m_pChicken.end(); )
+//-----------------------------------------------------------------------------
+// Name : RecordPrevious () (Private)
+// Desc : Keeps where everything is before the last step of a batch, sorted
+//		by object id for RecordSnapshot() to look up.
+//-----------------------------------------------------------------------------
+void CGameApp::RecordPrevious()
+{
+	struct SByObject
 	{
-		CChicken& chicken = **it;
-		chicken.Tick(0.0f);
-		if (rand() % 1000 < 0.1)
-		{
-			CBullet* bullet = chicken.CreateBullet(m_pBBuffer);
-			m_bullets.push_back(bullet);
-		}
-		++it;
-	}
-	for (auto it = m_pBigBoss.begin(); it != m_pBigBoss.end(); )
+		bool operator()(const SDrawCommand& a, const SDrawCommand& b) const { return a.nObject < b.nObject; }
+	};
+
+	m_World.Record(m_SimDrawList);
+	m_PrevCommands = m_SimDrawList.GetCommands();
+	std::sort(m_PrevCommands.begin(), m_PrevCommands.end(), SByObject());
+}
+
+//-----------------------------------------------------------------------------
+// Name : RecordSnapshot () (Private)
+// Desc : Records the world into the snapshot being written. Sprites that
+//		did not exist a step earlier start from where they are now.
+//-----------------------------------------------------------------------------
+void CGameApp::RecordSnapshot(double fTime)
+{
+	struct SByObject
 	{
-		BigBoss& bigboss = **it;
-		bigboss.Tick(0.0f);
-		if (rand() % 1000 < 0.1)
-		{
-			CBullet* bullet = bigboss.CreateBullet(m_pBBuffer);
-			m_bullets.push_back(bullet);
-		}
-		++it;
-	}
-	for (auto it = m_pHealth.begin(); it != m_pHealth.end(); )
+		bool operator()(const SDrawCommand& a, uint32_t nObject) const { return a.nObject < nObject; }
+	};
+
+	m_World.Record(m_SimDrawList);
+
+	SWorldSnapshot& snapshot = m_Snapshots.GetWriteBuffer();
+	snapshot.commands			= m_SimDrawList.GetCommands();
+	snapshot.fTime				= fTime;
+	snapshot.nStep				= m_World.GetStepCount();
+	snapshot.iScore				= m_World.GetScore();
+	snapshot.iKilledChickens	= m_World.GetKilledChickens();
+	snapshot.iLevel				= m_World.GetLevel();
+	snapshot.bGameOver			= m_World.IsGameOver();
+
+	snapshot.previous.resize(snapshot.commands.size());
+	for (size_t i = 0; i < snapshot.commands.size(); i++)
 	{
-		CHealth& health = **it;
-		health.Tick(0.0f);
-		if (m_pPlayer->Intersects(health.m_pSprite) && !m_pPlayer->IsExploding())
+		const SDrawCommand& cmd = snapshot.commands[i];
+		SSpritePosition position = { cmd.x, cmd.y };
+
+		std::vector<SDrawCommand>::const_iterator it = std::lower_bound(m_PrevCommands.begin(), m_PrevCommands.end(), cmd.nObject, SByObject());
+		if (cmd.nObject != 0 && it != m_PrevCommands.end() && it->nObject == cmd.nObject)
 		{
-			m_pPlayer->AddLife();
-			delete* it;
-			it = m_pHealth.erase(it);
+			position.x = it->x;
+			position.y = it->y;
 		}
-		else
-			++it;
-	}
-	if (!m_pPlayer->IsExploding() && m_pPlayer->GetLives() < 1)
-		ShutDown();
-	if (m_iKilledChickens == 1)
-		m_iLevel = 1;
-	if(m_iKilledChickens > 1)
-		m_iLevel = 1+ m_iKilledChickens / 4;
-	if (m_pBigBoss.empty()  && m_iLevel == 5)
-	{
-		float pos = 00.0f;
-		BigBoss* m_bigboss = new BigBoss(m_pBBuffer, { pos, 100.0f }, { 1.0f, 0.0f });
-		
-		m_pBigBoss.push_back(m_bigboss);
-
 
+		snapshot.previous[i] = position;
 	}
-
-
-	// Poll & Process input devices
-	ProcessInput();
-
-	// Animate the game objects
-	AnimateObjects();
-
-	// Drawing the game objects
-	DrawObjects();
 }
 
 //-----------------------------------------------------------------------------
@@ -578,8 +682,8 @@ void CGameApp::ProcessInput( )
 	if ( pKeyBuffer[ VK_RIGHT ] & 0xF0 ) Direction |= CPlayer::DIR_RIGHT;
 
 	
-	// Move the player
-	m_pPlayer->Move(Direction);
+	// The simulation thread moves the player on its next step
+	m_nInputDirection = Direction;
 
 
 	// Now process the mouse (if the button is pressed)
@@ -597,39 +701,215 @@ void CGameApp::ProcessInput( )
 	} // End if Captured
 }
 
+//-----------------------------------------------------------------------------
+// Name : PlaySounds () (Private)
+// Desc : Plays what the world asked for. For each async sound Windows
+//		creates a thread, but only one, so sounds cannot overlap; the most
+//		important one of the frame is played.
+//-----------------------------------------------------------------------------
+void CGameApp::PlaySounds(unsigned int nSounds)
+{
+	if (nSounds & CPlayer::SOUND_EXPLOSION)
+		PlaySound("data/explosion.wav", NULL, SND_FILENAME | SND_ASYNC);
+	else if (nSounds & CPlayer::SOUND_JET_STOP)
+		PlaySound("data/jet-stop.wav", NULL, SND_FILENAME | SND_ASYNC);
+	else if (nSounds & CPlayer::SOUND_JET_START)
+		PlaySound("data/jet-start.wav", NULL, SND_FILENAME | SND_ASYNC);
+	else if (nSounds & CPlayer::SOUND_JET_CABIN)
+		PlaySound("data/jet-cabin.wav", NULL, SND_FILENAME | SND_ASYNC);
+}
+
 //-----------------------------------------------------------------------------
 // Name : AnimateObjects () (Private)
 // Desc : Animates the objects we currently have loaded.
 //-----------------------------------------------------------------------------
 void CGameApp::AnimateObjects()
 {
-	m_pPlayer->Update(m_Timer.GetTimeElapsed());
+	// The game objects move on the simulation thread, the background
+	// only needs to look smooth.
+	m_Background.Update(m_Timer.GetTimeElapsed());
 }
 
 //-----------------------------------------------------------------------------
 // Name : DrawObjects () (Private)
 // Desc : Draws the game objects
 //-----------------------------------------------------------------------------
-void CGameApp::DrawObjects()
+void CGameApp::DrawObjects(const SWorldSnapshot& snapshot)
+{
+	// Images created since the last pack (the first bullet of each kind)
+	// are moved into the atlas as well. The simulation thread may be
+	// creating sprites, so this waits for its step to end.
+	{
+		std::lock_guard<std::mutex> lock(g_AssetCache.GetLock());
+		if (g_AssetCache.IsAtlasDirty())
+			g_AssetCache.BuildAtlas();
+	}
+
+	// Replay the sprites of the snapshot, they are drawn sorted by layer
+	// and image. Positions are blended from a step earlier to the latest,
+	// by how far real time (less one step) has got between the two.
+	float fAlpha = (float)((CFixedTimestep::Now() - snapshot.fTime) / SIM_TIMESTEP);
+	if (fAlpha < 0.0f) fAlpha = 0.0f;
+	if (fAlpha > 1.0f) fAlpha = 1.0f;
+
+	m_DrawList.Begin();
+
+	for (size_t i = 0; i < snapshot.commands.size(); i++)
+	{
+		SDrawCommand cmd = snapshot.commands[i];
+		const SSpritePosition& previous = snapshot.previous[i];
+
+		// Jumps (the player respawning) are not blended
+		int dx = cmd.x - previous.x, dy = cmd.y - previous.y;
+		if (abs(dx) <= INTERPOLATE_MAX_DISTANCE && abs(dy) <= INTERPOLATE_MAX_DISTANCE)
+		{
+			cmd.x = previous.x + (int)floorf(dx * fAlpha + 0.5f);
+			cmd.y = previous.y + (int)floorf(dy * fAlpha + 0.5f);
+		}
+
+		m_DrawList.Add(cmd);
+	}
+
+	// Work out what changed since the last frame. A background that moved
+	// by a whole pixel changes everything.
+	CFrameBuffer& frameBuffer = m_pBBuffer->getFrameBuffer();
+	m_DirtyRegion.Begin(frameBuffer.Width(), frameBuffer.Height());
+	m_DrawList.CollectDirty(m_DirtyRegion);
+
+	int backgroundRow = m_Background.GetRow();
+	if (m_bFullRedraw || backgroundRow != m_iBackgroundRow)
+		m_DirtyRegion.MarkAll();
+
+	m_iBackgroundRow = backgroundRow;
+	m_bFullRedraw	 = false;
+
+	// Sprites are drawn straight into the framebuffer memory
+	m_pBBuffer->flush();
+
+	if (m_DirtyRegion.IsFull())
+	{
+		m_Background.Draw(frameBuffer);
+		m_DrawList.SubmitParallel(frameBuffer, m_RenderPool);
+	}
+	else
+	{
+		// Restore the background under each rectangle and draw what
+		// overlaps it, through a view clipped to the rectangle.
+		const std::vector<SAtlasRect>& rects = m_DirtyRegion.GetRects();
+		for (size_t i = 0; i < rects.size(); i++)
+		{
+			const SAtlasRect& rc = rects[i];
+
+			CFrameBuffer view;
+			view.Attach(frameBuffer.Row(rc.y) + rc.x, rc.w, rc.h, frameBuffer.Pitch());
+
+			m_Background.Draw(view, rc.x, rc.y);
+			m_DrawList.Submit(view, rc.x, rc.y);
+		}
+	}
+
+	m_pBBuffer->present(m_DirtyRegion);
+}
+
+//-----------------------------------------------------------------------------
+// Name : LogTileScaling () (Private)
+// Desc : Times the tile-parallel draw of the current frame with 1 to N
+//		threads and writes the result to the debugger output.
+//-----------------------------------------------------------------------------
+void CGameApp::LogTileScaling()
 {
-	m_pBBuffer->reset();
+	std::vector<double> msPerFrame;
+	bool bMatch = m_DrawList.MeasureTileScaling(m_nViewWidth, m_nViewHeight, m_RenderPool.GetThreadCount(), 100, msPerFrame);
+
+	char szLine[128];
+	sprintf_s(szLine, "Tile scaling, %u draws, output %s\n", m_DrawList.GetDrawCount(), bMatch ? "identical" : "DIFFERS");
+	OutputDebugStringA(szLine);
+
+	for (size_t i = 0; i < msPerFrame.size(); i++)
+	{
+		sprintf_s(szLine, "  %2u threads: %.3f ms (x%.2f)\n", (unsigned)(i + 1), msPerFrame[i], msPerFrame[0] / msPerFrame[i]);
+		OutputDebugStringA(szLine);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : LogBulletUpdate () (Private)
+// Desc : Times moving 100k bullets as objects and as arrays and writes the
+//		result to the debugger output.
+//-----------------------------------------------------------------------------
+void CGameApp::LogBulletUpdate()
+{
+	double msObjects = 0.0, msArrays = 0.0;
+	bool bMatch;
+	{
+		// The bullet objects load their sprites through the cache
+		std::lock_guard<std::mutex> lock(g_AssetCache.GetLock());
+		bMatch = CGameWorld::MeasureBulletUpdate(100000, 100, msObjects, msArrays);
+	}
+
+	char szLine[128];
+	sprintf_s(szLine, "Bullet update, 100000 bullets: objects %.3f ms, arrays %.3f ms (x%.1f), %s\n",
+			  msObjects, msArrays, msObjects / msArrays, bMatch ? "identical" : "DIFFERS");
+	OutputDebugStringA(szLine);
+}
 
-	if (m_fBackgroundOffset <= -1154.0f) m_fBackgroundOffset = 0.2f;
-	m_imgBackground.Paint(m_pBBuffer->getDC(), 0, m_fBackgroundOffset -= 0.2f);
+//-----------------------------------------------------------------------------
+// Name : LogSpriteDraws () (Private)
+// Desc : Times 1000 draws of each color keyed sprite at its game scale,
+//		stretched and keyed per draw and from the cached mask, and writes
+//		the result to the debugger output.
+//-----------------------------------------------------------------------------
+void CGameApp::LogSpriteDraws()
+{
+	static const struct { const char* szFileName; uint32_t nKeyColor; float fScale; } sprites[] =
+	{
+		{ "data/bulletandmask.bmp",			0x00FF00FF, 0.1f },
+		{ "data/ChickenEnemy.bmp",			0x00000000, 0.5f },
+		{ "data/Health.bmp",				0x00FFFFFF, 1.0f },
+		{ "data/BigBossImgAndMask.bmp",		0x00FF00FF, 1.0f },
+	};
 
-	m_pPlayer->Draw();
+	// The sprites load their images through the cache
+	std::lock_guard<std::mutex> lock(g_AssetCache.GetLock());
 
-	for (CBullet* bullet : m_bullets)
-		bullet->Draw();
+	char szLine[160];
+	for (int i = 0; i < sizeof(sprites) / sizeof(sprites[0]); i++)
+	{
+		double fStretched, fCached;
+		if (!Sprite::measureDraws(sprites[i].szFileName, sprites[i].nKeyColor, sprites[i].fScale, 1000, fStretched, fCached))
+			continue;
 
-	for (CChicken* chicken : m_pChicken)
-		chicken->Draw();
+		sprintf_s(szLine, "Sprite draws, %-30s x%.1f: stretched and keyed %.0f/s, cached mask %.0f/s (x%.1f)\n",
+				  sprites[i].szFileName, sprites[i].fScale, fStretched, fCached, fCached / fStretched);
+		OutputDebugStringA(szLine);
+	}
+}
 
-	for (CHealth* health : m_pHealth)
-		health->Draw();
+//-----------------------------------------------------------------------------
+// Name : LogBroadphase () (Private)
+// Desc : Times finding what 20k bullets overlap among 1k targets with and
+//		without the spatial grid, and each box kernel, overlapping and
+//		swept, and writes the results to the debugger output.
+//-----------------------------------------------------------------------------
+void CGameApp::LogBroadphase()
+{
+	double msBruteForce = 0.0, msGrid = 0.0;
+	bool bMatch = CGameWorld::MeasureBroadphase(20000, 1000, 10, msBruteForce, msGrid);
 
-	for (BigBoss* bigboss : m_pBigBoss)
-		bigboss->Draw();
+	char szLine[128];
+	sprintf_s(szLine, "Broadphase, 20000 bullets x 1000 targets: all pairs %.3f ms, grid %.3f ms (x%.1f), %s\n",
+			  msBruteForce, msGrid, msBruteForce / msGrid, bMatch ? "identical" : "DIFFERS");
+	OutputDebugStringA(szLine);
 
-	m_pBBuffer->present();
+	for (int level = BLIT_SCALAR; level < BLIT_LEVEL_COUNT; level++)
+	{
+		double fRate = CAabbBatch::MeasureThroughput((EBlitLevel)level);
+		if (fRate <= 0.0)
+			continue;
+
+		double fSweepRate = CAabbBatch::MeasureSweepThroughput((EBlitLevel)level);
+		sprintf_s(szLine, "  Box kernel %-6s: %.0f boxes/us, swept %.0f boxes/us%s\n", CBlitter::GetKernels((EBlitLevel)level).szName,
+				  fRate, fSweepRate, level == CAabbBatch::GetLevel() ? " (in use)" : "");
+		OutputDebugStringA(szLine);
+	}
 }
@@ -10,33 +10,28 @@
 // CPlayer Specific Includes
 //-----------------------------------------------------------------------------
 #include "CPlayer.h"
-#include "CGameApp.h"
 #include "CBoundingBox.inl"
-
-extern CGameApp g_App;
+#include <string.h>
 
 //-----------------------------------------------------------------------------
 // Name : CPlayer () (Constructor)
 // Desc : CPlayer Class Constructor
 //-----------------------------------------------------------------------------
-CPlayer::CPlayer(const BackBuffer *pBackBuffer)
+CPlayer::CPlayer()
 {
 	//m_pSprite = new Sprite("data/planeimg.bmp", "data/planemask.bmp");
-	m_pSprite = new Sprite("data/planeimgandmask.bmp", RGB(0xff,0x00, 0xff));
-	m_pSprite->setBackBuffer( pBackBuffer );
+	m_pSprite = new Sprite("data/planeimgandmask.bmp", PackPixel(0xff,0x00, 0xff));
 	m_eSpeedState = SPEED_STOP;
 	m_fTimer = 0;
+	m_nSounds = 0;
 	m_iLives = 0;
+	for (int i = 0; i < 3; ++i)
+		m_pLifeImages[i] = NULL;
 
 	// Animation frame crop rectangle
-	RECT r;
-	r.left = 0;
-	r.top = 0;
-	r.right = 128;
-	r.bottom = 128;
+	SAtlasRect r = { 0, 0, 128, 128 };
 
 	m_pExplosionSprite	= new AnimatedSprite("data/explosion.bmp", "data/explosionmask.bmp", r, 16);
-	m_pExplosionSprite->setBackBuffer( pBackBuffer );
 	m_bExplosion		= false;
 	m_iExplosionFrame	= 0;
 }
@@ -49,6 +44,8 @@ CPlayer::~CPlayer()
 {
 	delete m_pSprite;
 	delete m_pExplosionSprite;
+	for (int i = 0; i < 3; ++i)
+		delete m_pLifeImages[i];
 }
 
 void CPlayer::Update(float dt)
@@ -60,10 +57,7 @@ void CPlayer::Update(float dt)
 	// Get velocity
 	double v = m_pSprite->mVelocity.Magnitude();
 
-	// NOTE: for each async sound played Windows creates a thread for you
-	// but only one, so you cannot play multiple sounds at once.
-	// This creation/destruction of threads also leads to bad performance
-	// so this method is not recommanded to be used in complex projects.
+	// Sounds are only flagged here, whoever runs the world plays them.
 
 	// update internal time counter used in sound handling (not to overlap sounds)
 	m_fTimer += dt;
@@ -75,7 +69,7 @@ void CPlayer::Update(float dt)
 		if(v > 35.0f)
 		{
 			m_eSpeedState = SPEED_START;
-			PlaySound("data/jet-start.wav", NULL, SND_FILENAME | SND_ASYNC);
+			m_nSounds |= SOUND_JET_START;
 			m_fTimer = 0;
 		}
 		break;
@@ -83,50 +77,42 @@ void CPlayer::Update(float dt)
 		if(v < 25.0f)
 		{
 			m_eSpeedState = SPEED_STOP;
-			PlaySound("data/jet-stop.wav", NULL, SND_FILENAME | SND_ASYNC);
+			m_nSounds |= SOUND_JET_STOP;
 			m_fTimer = 0;
 		}
 		else
 			if(m_fTimer > 1.f)
 			{
-				PlaySound("data/jet-cabin.wav", NULL, SND_FILENAME | SND_ASYNC);
+				m_nSounds |= SOUND_JET_CABIN;
 				m_fTimer = 0;
 			}
 		break;
 	}
-
-	// NOTE: For sound you also can use MIDI but it's Win32 API it is a bit hard
-	// see msdn reference: http://msdn.microsoft.com/en-us/library/ms711640.aspx
-	// In this case you can use a C++ wrapper for it. See the following article:
-	// http://www.codeproject.com/KB/audio-video/midiwrapper.aspx (with code also)
 }
 
-void CPlayer::Init(const BackBuffer* pBackBuffer)
+void CPlayer::Init()
 {
 	m_iLives = 3;
 	for (int i = 0; i < m_iLives; ++i) {
-		m_pLifeImages[i] = new Sprite("data/Heart.bmp", RGB(0xff, 0xff, 0xff));
-		m_pLifeImages[i]->setBackBuffer(pBackBuffer);
+		m_pLifeImages[i] = new Sprite("data/Heart.bmp", PackPixel(0xff, 0xff, 0xff));
 		m_pLifeImages[i]->mPosition.x = 135 + i * (m_pLifeImages[i]->width() * 0.1f);
 		m_pLifeImages[i]->mPosition.y = 135;
 		m_pLifeImages[i]->setScale(0.1f, 0.1f);
 	}
 }
 
-void CPlayer::Draw()
+void CPlayer::Draw(CDrawList& drawList)
 {
 	for (int i = 0; i < m_iLives; i++)
-		m_pLifeImages[i]->draw();
+		m_pLifeImages[i]->draw(drawList, DRAWLAYER_HUD);
 	if (!m_bExplosion)
-		m_pSprite->draw();
+		m_pSprite->draw(drawList, DRAWLAYER_PLAYER);
 	else
-		m_pExplosionSprite->draw();
+		m_pExplosionSprite->draw(drawList, DRAWLAYER_PLAYER);
 }
 
-void CPlayer::Move(ULONG ulDirection)
+void CPlayer::Move(unsigned long ulDirection, int width, int height)
 {
-	int width, height;
-	g_App.GetWindowSize(width, height);
 	if( ulDirection & CPlayer::DIR_LEFT )
 		m_pSprite->mVelocity.x -= 2.1;
 	double pos = m_pSprite->mPosition.x - m_pSprite->width() / 2;
@@ -174,46 +160,25 @@ void CPlayer::Intersects(CPlayer* player)
 	}
 }
 
-bool CPlayer::Intersects(Sprite* sprite)
+bool CPlayer::Intersects(const CHitMask& mask, int x, int y)
 {
-	Vec2 pPosition = sprite->mPosition;
-	Vec2 pSize = Vec2(sprite->width(), sprite->height());
-
-	Vec2& position = m_pSprite->mPosition;
-	Vec2& velocity = m_pSprite->mVelocity;
-
-	CBoundingBox box(m_pSprite->mPosition, m_pSprite->mPosition + Vec2(m_pSprite->width(), m_pSprite->height()));
-	CBoundingBox chickenBox(pPosition, pPosition + pSize);
+	const CSpriteAsset* pImage = m_pSprite->drawnImage();
+	if (!pImage)
+		return false;
 
-	// Calculate the vertical distance between the player and the chicken bullet
-	float verticalDistance = abs(m_pSprite->mPosition.y - pPosition.y);
-
-	// Check if the player's horizontal position is within the chicken bullet's horizontal bounds
-	if (box.Intersects(chickenBox) && verticalDistance < m_pSprite->height() / 2 )
-		return true;
-
-
-	return false;
+	SAtlasRect rc = m_pSprite->drawnRect();
+	return CHitMask::Overlap(pImage->HitMask(), rc.x, rc.y, mask, x, y);
 }
-bool CPlayer::IntersectsBoss(Sprite* bossSprite)
-{
-	Vec2 bossPosition = bossSprite->mPosition;
-	Vec2 bossSize = Vec2(bossSprite->width(), bossSprite->height());
-
-	Vec2& playerPosition = m_pSprite->mPosition;
-	Vec2& playerVelocity = m_pSprite->mVelocity;
-
-	CBoundingBox playerBox(m_pSprite->mPosition, m_pSprite->mPosition + Vec2(m_pSprite->width(), m_pSprite->height()));
-	CBoundingBox bossBox(bossPosition, bossPosition + bossSize);
-
-	// Calculate the vertical distance between the player and the boss
-	float verticalDistance = abs(m_pSprite->mPosition.y - bossPosition.y);
 
-	// Check if the player's horizontal position is within the boss's horizontal bounds
-	if (playerBox.Intersects(bossBox) && verticalDistance < m_pSprite->height() / 2)
-		return true;
+SAtlasRect CPlayer::GetHitRect()
+{
+	return m_pSprite->drawnRect();
+}
 
-	return false;
+const CHitMask* CPlayer::GetHitMask()
+{
+	const CSpriteAsset* pImage = m_pSprite->drawnImage();
+	return pImage ? &pImage->HitMask() : NULL;
 }
 
 
@@ -239,7 +204,7 @@ void CPlayer::Explode()
 	m_iLives -= 1;
 	m_pExplosionSprite->mPosition = m_pSprite->mPosition;
 	m_pExplosionSprite->SetFrame(0);
-	PlaySound("data/explosion.wav", NULL, SND_FILENAME | SND_ASYNC);
+	m_nSounds |= SOUND_EXPLOSION;
 	m_bExplosion = true;
 }
 
@@ -277,12 +242,53 @@ void CPlayer::AddLife()
 		m_iLives++;
 }
 
+unsigned int CPlayer::TakeSounds()
+{
+	unsigned int nSounds = m_nSounds;
+	m_nSounds = 0;
+	return nSounds;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetState ()
+// Desc : Copies out what Move(), Update() and the explosion change. Sounds
+//		not taken yet are left behind.
+//-----------------------------------------------------------------------------
+void CPlayer::GetState(SPlayerState& state) const
+{
+	memset(&state, 0, sizeof(state));
+	state.fX				= m_pSprite->mPosition.x;
+	state.fY				= m_pSprite->mPosition.y;
+	state.fVelX				= m_pSprite->mVelocity.x;
+	state.fVelY				= m_pSprite->mVelocity.y;
+	state.fExplosionX		= m_pExplosionSprite->mPosition.x;
+	state.fExplosionY		= m_pExplosionSprite->mPosition.y;
+	state.fTimer			= m_fTimer;
+	state.iSpeedState		= m_eSpeedState;
+	state.iLives			= m_iLives;
+	state.iExplosionFrame	= m_iExplosionFrame;
+	state.bExplosion		= m_bExplosion;
+}
 
-CBullet* CPlayer::CreateBullet(BackBuffer* buffer)
+//-----------------------------------------------------------------------------
+// Name : SetState ()
+// Desc : Puts back a state from GetState(). The explosion shows the frame
+//		AdvanceExplosion() last set, the one before the count.
+//-----------------------------------------------------------------------------
+void CPlayer::SetState(const SPlayerState& state)
 {
-	CBullet* bullet = new CBullet(buffer, Vec2(0.0f, -1.0f));
-	bullet->m_pSprite->setScale(0.1f, 0.1f);
-	float posx = m_pSprite->mPosition.x + m_pSprite->width() / 2 + (round(bullet->m_pSprite->width() * 0.1f) / 2);
-	bullet->SetPosition(posx, m_pSprite->mPosition.y);
-	return bullet;
-}
\ No newline at end of file
+	m_pSprite->mPosition			= Vec2(state.fX, state.fY);
+	m_pSprite->mVelocity			= Vec2(state.fVelX, state.fVelY);
+	m_pExplosionSprite->mPosition	= Vec2(state.fExplosionX, state.fExplosionY);
+	m_fTimer			= state.fTimer;
+	m_eSpeedState		= state.iSpeedState == SPEED_START ? SPEED_START : SPEED_STOP;
+	m_iLives			= state.iLives;
+	m_iExplosionFrame	= state.iExplosionFrame;
+	m_bExplosion		= state.bExplosion != 0;
+	m_nSounds			= 0;
+
+	if (m_iExplosionFrame > 0 && m_iExplosionFrame <= m_pExplosionSprite->GetFrameCount())
+		m_pExplosionSprite->SetFrame(m_iExplosionFrame - 1);
+	else
+		m_pExplosionSprite->SetFrame(0);
+}
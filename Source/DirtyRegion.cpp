@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// File: DirtyRegion.cpp
+//
+// Desc: Tracks which parts of the screen changed this frame.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CDirtyRegion Specific Includes
+//-----------------------------------------------------------------------------
+#include "DirtyRegion.h"
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// CDirtyRegion Member Functions
+//-----------------------------------------------------------------------------
+CDirtyRegion::CDirtyRegion()
+{
+	m_iWidth		= 0;
+	m_iHeight		= 0;
+	m_nArea			= 0;
+	m_fThreshold	= DIRTY_FULL_THRESHOLD;
+	m_bFull			= false;
+}
+
+CDirtyRegion::~CDirtyRegion()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Begin ()
+// Desc : Starts an empty region for a width x height screen.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Begin(int width, int height)
+{
+	m_iWidth	= width;
+	m_iHeight	= height;
+	m_nArea		= 0;
+	m_bFull		= false;
+	m_Rects.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Add ()
+// Desc : Adds a rectangle. Anything it overlaps or touches is absorbed into
+//		one bounding rectangle, repeated until the result overlaps nothing.
+//-----------------------------------------------------------------------------
+void CDirtyRegion::Add(int x, int y, int w, int h)
+{
+	if (m_bFull)
+		return;
+
+	// Clip to the screen
+	int x0 = std::max(x, 0), y0 = std::max(y, 0);
+	int x1 = std::min(x + w, m_iWidth), y1 = std::min(y + h, m_iHeight);
+	if (x0 >= x1 || y0 >= y1)
+		return;
+
+	bool bMerged = true;
+	while (bMerged)
+	{
+		bMerged = false;
+		for (size_t i = 0; i < m_Rects.size(); i++)
+		{
+			const SAtlasRect& rc = m_Rects[i];
+			if (rc.x > x1 || x0 > rc.x + rc.w || rc.y > y1 || y0 > rc.y + rc.h)
+				continue;
+
+			x0 = std::min(x0, rc.x);
+			y0 = std::min(y0, rc.y);
+			x1 = std::max(x1, rc.x + rc.w);
+			y1 = std::max(y1, rc.y + rc.h);
+
+			m_nArea -= (size_t)rc.w * rc.h;
+			m_Rects[i] = m_Rects.back();
+			m_Rects.pop_back();
+			bMerged = true;
+			break;
+		}
+	}
+
+	SAtlasRect rc = { x0, y0, x1 - x0, y1 - y0 };
+	m_Rects.push_back(rc);
+	m_nArea += (size_t)rc.w * rc.h;
+
+	if (IsFull())
+	{
+		m_bFull = true;
+		m_Rects.clear();
+		m_nArea = 0;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsFull ()
+// Desc : True when the whole screen should simply be redrawn.
+//-----------------------------------------------------------------------------
+bool CDirtyRegion::IsFull() const
+{
+	return m_bFull || GetCoverage() > m_fThreshold;
+}
+
+float CDirtyRegion::GetCoverage() const
+{
+	if (m_bFull)
+		return 1.0f;
+
+	size_t screen = (size_t)m_iWidth * m_iHeight;
+	return screen ? (float)m_nArea / (float)screen : 0.0f;
+}
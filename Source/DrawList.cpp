@@ -0,0 +1,382 @@
+//-----------------------------------------------------------------------------
+// File: DrawList.cpp
+//
+// Desc: Per frame list of sprite draw commands.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CDrawList Specific Includes
+//-----------------------------------------------------------------------------
+#include "DrawList.h"
+#include "AssetCache.h"
+#include "Blitter.h"
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// CDrawList Member Functions
+//-----------------------------------------------------------------------------
+CDrawList::CDrawList()
+{
+	m_bSorted	= false;
+	m_nDraws	= 0;
+	m_nBatches	= 0;
+	m_nTilesX	= 0;
+	m_nTilesY	= 0;
+}
+
+CDrawList::~CDrawList()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Begin ()
+// Desc : Starts a new frame. The arrays keep their capacity, so a steady
+//		scene does not allocate.
+//-----------------------------------------------------------------------------
+void CDrawList::Begin()
+{
+	m_Commands.clear();
+	m_Items.clear();
+	m_bSorted	= false;
+	m_nDraws	= 0;
+	m_nBatches	= 0;
+}
+
+void CDrawList::Add(EDrawLayer eLayer, const CSpriteAsset* pAsset, int x, int y, float fScaleX, float fScaleY, int iFrame, uint32_t nObject)
+{
+	SDrawCommand cmd = { eLayer, pAsset, x, y, fScaleX, fScaleY, iFrame, nObject };
+	Add(cmd);
+}
+
+void CDrawList::Add(const SDrawCommand& cmd)
+{
+	if (!cmd.pAsset)
+		return;
+
+	SSortItem item = { ((uint32_t)cmd.eLayer << 24) | (cmd.pAsset->GetId() & 0x00FFFFFF), (uint32_t)m_Commands.size() };
+
+	m_Commands.push_back(cmd);
+	m_Items.push_back(item);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Sort () (Private)
+// Desc : Stable LSD radix sort of the keys, one pass per byte. Passes where
+//		every key has the same byte (usually the top asset id bytes) are
+//		skipped.
+//-----------------------------------------------------------------------------
+void CDrawList::Sort()
+{
+	size_t count = m_Items.size();
+	m_Scratch.resize(count);
+
+	SSortItem* pSrc = count ? &m_Items[0] : NULL;
+	SSortItem* pDst = count ? &m_Scratch[0] : NULL;
+
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		size_t histogram[256];
+		memset(histogram, 0, sizeof(histogram));
+
+		for (size_t i = 0; i < count; i++)
+			histogram[(pSrc[i].key >> shift) & 0xFF]++;
+
+		if (count == 0 || histogram[(pSrc[0].key >> shift) & 0xFF] == count)
+			continue;
+
+		size_t offset = 0;
+		for (int b = 0; b < 256; b++)
+		{
+			size_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+
+		for (size_t i = 0; i < count; i++)
+			pDst[histogram[(pSrc[i].key >> shift) & 0xFF]++] = pSrc[i];
+
+		SSortItem* pTemp = pSrc; pSrc = pDst; pDst = pTemp;
+	}
+
+	// An odd number of passes leaves the result in the scratch array
+	if (count && pSrc != &m_Items[0])
+		m_Items.swap(m_Scratch);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Submit ()
+// Desc : Sorts the commands (once per frame) and draws them, one batch per
+//		run of commands that share layer and image. target may be a view of
+//		part of the screen whose top-left is (originX, originY); commands
+//		outside it are skipped.
+//-----------------------------------------------------------------------------
+void CDrawList::Submit(CFrameBuffer& target, int originX, int originY)
+{
+	if (!m_bSorted)
+	{
+		Sort();
+		m_bSorted = true;
+	}
+
+	for (size_t i = 0; i < m_Items.size(); )
+	{
+		uint32_t key = m_Items[i].key;
+		bool bBatch = false;
+
+		// Same image back to back, its pixels and spans stay in cache
+		for (; i < m_Items.size() && m_Items[i].key == key; i++)
+		{
+			if (!DrawCommand(target, m_Commands[m_Items[i].index], originX, originY))
+				continue;
+
+			m_nDraws++;
+			bBatch = true;
+		}
+
+		if (bBatch)
+			m_nBatches++;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : SubmitParallel ()
+// Desc : Bins the sorted commands into tiles, then has the pool draw one
+//		tile per job through a view of the target. Bins keep the sorted
+//		order and tiles do not overlap, so the output does not depend on
+//		the thread count or on which thread drew which tile.
+//-----------------------------------------------------------------------------
+void CDrawList::SubmitParallel(CFrameBuffer& target, CWorkerPool& pool, int originX, int originY)
+{
+	if (!m_bSorted)
+	{
+		Sort();
+		m_bSorted = true;
+	}
+
+	BinTiles(target.Width(), target.Height(), originX, originY);
+
+	std::function<void(int)> drawTile = [&](int tile)
+	{
+		uint32_t begin = m_TileStart[tile], end = m_TileStart[tile + 1];
+		if (begin == end)
+			return;
+
+		int x = (tile % m_nTilesX) * DRAW_TILE_SIZE;
+		int y = (tile / m_nTilesX) * DRAW_TILE_SIZE;
+		int w = x + DRAW_TILE_SIZE > target.Width() ? target.Width() - x : DRAW_TILE_SIZE;
+		int h = y + DRAW_TILE_SIZE > target.Height() ? target.Height() - y : DRAW_TILE_SIZE;
+
+		CFrameBuffer view;
+		view.Attach(target.Row(y) + x, w, h, target.Pitch());
+
+		for (uint32_t i = begin; i < end; i++)
+			DrawCommand(view, m_Commands[m_TileItems[i]], originX + x, originY + y);
+	};
+
+	pool.Run(m_nTilesX * m_nTilesY, drawTile);
+}
+
+//-----------------------------------------------------------------------------
+// Name : BinTiles () (Private)
+// Desc : Counting pass, prefix sum, then a fill pass, so the bins live in
+//		one array that keeps its capacity from frame to frame. Also counts
+//		draws and batches the way Submit() does.
+//-----------------------------------------------------------------------------
+void CDrawList::BinTiles(int width, int height, int originX, int originY)
+{
+	m_nTilesX = (width + DRAW_TILE_SIZE - 1) / DRAW_TILE_SIZE;
+	m_nTilesY = (height + DRAW_TILE_SIZE - 1) / DRAW_TILE_SIZE;
+
+	size_t tileCount = (size_t)m_nTilesX * m_nTilesY;
+	m_TileStart.assign(tileCount + 1, 0);
+
+	// Tile range of every visible command, -1 for the rest
+	m_Scratch.resize(m_Items.size());
+	for (size_t i = 0; i < m_Items.size(); )
+	{
+		uint32_t key = m_Items[i].key;
+		bool bBatch = false;
+
+		for (; i < m_Items.size() && m_Items[i].key == key; i++)
+		{
+			SAtlasRect rc = GetBounds(m_Commands[m_Items[i].index]);
+			rc.x -= originX;
+			rc.y -= originY;
+
+			m_Scratch[i].key = (uint32_t)-1;
+			if (rc.x >= width || rc.y >= height || rc.x + rc.w <= 0 || rc.y + rc.h <= 0 || rc.w <= 0 || rc.h <= 0)
+				continue;
+
+			int tx0 = std::max(rc.x, 0) / DRAW_TILE_SIZE;
+			int ty0 = std::max(rc.y, 0) / DRAW_TILE_SIZE;
+			int tx1 = (std::min(rc.x + rc.w, width) - 1) / DRAW_TILE_SIZE;
+			int ty1 = (std::min(rc.y + rc.h, height) - 1) / DRAW_TILE_SIZE;
+
+			// Packed as 8 bits per tile coordinate, enough for 16k pixels
+			m_Scratch[i].key	= (uint32_t)(tx0 | (tx1 << 8) | (ty0 << 16) | (ty1 << 24));
+			m_Scratch[i].index	= m_Items[i].index;
+
+			for (int ty = ty0; ty <= ty1; ty++)
+				for (int tx = tx0; tx <= tx1; tx++)
+					m_TileStart[ty * m_nTilesX + tx + 1]++;
+
+			m_nDraws++;
+			bBatch = true;
+		}
+
+		if (bBatch)
+			m_nBatches++;
+	}
+
+	for (size_t t = 0; t < tileCount; t++)
+		m_TileStart[t + 1] += m_TileStart[t];
+
+	m_TileItems.resize(m_TileStart[tileCount]);
+
+	m_TileFill.assign(m_TileStart.begin(), m_TileStart.end() - 1);
+	for (size_t i = 0; i < m_Scratch.size(); i++)
+	{
+		uint32_t range = m_Scratch[i].key;
+		if (range == (uint32_t)-1)
+			continue;
+
+		int tx0 = range & 0xFF, tx1 = (range >> 8) & 0xFF;
+		int ty0 = (range >> 16) & 0xFF, ty1 = range >> 24;
+		for (int ty = ty0; ty <= ty1; ty++)
+			for (int tx = tx0; tx <= tx1; tx++)
+				m_TileItems[m_TileFill[ty * m_nTilesX + tx]++] = m_Scratch[i].index;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawCommand () (Private, Static)
+// Desc : Draws one command into target, whose top-left is (originX, originY)
+//		on screen. Returns false when it lies outside the target.
+//-----------------------------------------------------------------------------
+bool CDrawList::DrawCommand(CFrameBuffer& target, const SDrawCommand& cmd, int originX, int originY)
+{
+	SAtlasRect rcSource;
+	SAtlasRect rc = GetBounds(cmd, &rcSource);
+	rc.x -= originX;
+	rc.y -= originY;
+
+	if (rc.x >= target.Width() || rc.y >= target.Height() || rc.x + rc.w <= 0 || rc.y + rc.h <= 0)
+		return false;
+
+	const CSpriteAsset* pAsset = cmd.pAsset;
+	if (rc.w == rcSource.w && rc.h == rcSource.h && pAsset->Spans().IsValid())
+		CBlitter::BlitSpans(target, rc.x, rc.y, pAsset->Image(), pAsset->Spans(), rcSource.x, rcSource.y, rcSource.w, rcSource.h);
+	else
+		CBlitter::BlitStretched(target, rc.x, rc.y, rc.w, rc.h, pAsset->Image(), rcSource.x, rcSource.y, rcSource.w, rcSource.h, BLIT_ALPHA);
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureTileScaling ()
+// Desc : Draws the recorded frame with Submit() once for reference, then
+//		times SubmitParallel() for every thread count. The frame counters
+//		are left as they were.
+//-----------------------------------------------------------------------------
+bool CDrawList::MeasureTileScaling(int width, int height, int maxThreads, int iterations, std::vector<double>& msPerFrame)
+{
+	unsigned int nDraws = m_nDraws, nBatches = m_nBatches;
+	bool bMatch = true;
+
+	CFrameBuffer reference, image;
+	if (!reference.Create(width, height) || !image.Create(width, height))
+		return false;
+
+	reference.Clear(0x00FFFFFF);
+	Submit(reference);
+
+	msPerFrame.clear();
+	for (int nThreads = 1; nThreads <= maxThreads; nThreads++)
+	{
+		CWorkerPool pool;
+		pool.Start(nThreads);
+
+		// Only the submit is timed, the clear is the same for every count
+		double seconds = 0.0;
+		for (int i = 0; i < iterations; i++)
+		{
+			image.Clear(0x00FFFFFF);
+
+			std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+			SubmitParallel(image, pool);
+			seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+		}
+		msPerFrame.push_back(seconds * 1000.0 / iterations);
+
+		for (int y = 0; y < height; y++)
+			if (memcmp(image.Row(y), reference.Row(y), width * sizeof(uint32_t)) != 0)
+				bMatch = false;
+	}
+
+	m_nDraws	= nDraws;
+	m_nBatches	= nBatches;
+	return bMatch;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CollectDirty ()
+// Desc : Compares this frame's (image, frame, bounds) set with the last one.
+//		Both are sorted, so one merge walk finds what is only in one of them.
+//-----------------------------------------------------------------------------
+void CDrawList::CollectDirty(CDirtyRegion& region)
+{
+	m_Current.clear();
+	for (size_t i = 0; i < m_Commands.size(); i++)
+	{
+		SDrawSignature sig = { m_Commands[i].pAsset, m_Commands[i].iFrame, GetBounds(m_Commands[i]) };
+		m_Current.push_back(sig);
+	}
+	std::sort(m_Current.begin(), m_Current.end());
+
+	size_t i = 0, j = 0;
+	while (i < m_Current.size() || j < m_Previous.size())
+	{
+		if (j == m_Previous.size() || (i < m_Current.size() && m_Current[i] < m_Previous[j]))
+			region.Add(m_Current[i++].rcBounds);
+		else if (i == m_Current.size() || m_Previous[j] < m_Current[i])
+			region.Add(m_Previous[j++].rcBounds);
+		else
+			i++, j++;
+	}
+
+	m_Previous.swap(m_Current);
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBounds () (Private, Static)
+// Desc : Screen rectangle a command covers, and optionally the source
+//		rectangle it is drawn from.
+//-----------------------------------------------------------------------------
+SAtlasRect CDrawList::GetBounds(const SDrawCommand& cmd, SAtlasRect* pSource)
+{
+	const CSpriteAsset* pAsset = cmd.pAsset;
+
+	SAtlasRect rc = { 0, 0, pAsset->Width(), pAsset->Height() };
+	if (cmd.iFrame >= 0)
+		rc = pAsset->GetFrame(cmd.iFrame).rc;
+
+	if (pSource)
+		*pSource = rc;
+
+	SAtlasRect bounds = { cmd.x, cmd.y, (int)floor(rc.w * cmd.fScaleX + 0.5f), (int)floor(rc.h * cmd.fScaleY + 0.5f) };
+	return bounds;
+}
+
+bool CDrawList::SDrawSignature::operator<(const SDrawSignature& rhs) const
+{
+	if (pAsset != rhs.pAsset)				return pAsset < rhs.pAsset;
+	if (iFrame != rhs.iFrame)				return iFrame < rhs.iFrame;
+	if (rcBounds.x != rhs.rcBounds.x)		return rcBounds.x < rhs.rcBounds.x;
+	if (rcBounds.y != rhs.rcBounds.y)		return rcBounds.y < rhs.rcBounds.y;
+	if (rcBounds.w != rhs.rcBounds.w)		return rcBounds.w < rhs.rcBounds.w;
+	return rcBounds.h < rhs.rcBounds.h;
+}
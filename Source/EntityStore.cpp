@@ -0,0 +1,142 @@
+//-----------------------------------------------------------------------------
+// File: EntityStore.cpp
+//
+// Desc: Structure of arrays storage for one kind of entity.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "EntityStore.h"
+
+//-----------------------------------------------------------------------------
+// CEntityStore Member Functions
+//-----------------------------------------------------------------------------
+CEntityStore::CEntityStore()
+{
+	m_nCapacity		= 0;
+	m_nPeak			= 0;
+	m_nExhausted	= 0;
+}
+
+CEntityStore::~CEntityStore()
+{
+}
+
+SSlotHandle CEntityStore::Add(float x, float y, float vx, float vy, float scale, uint16_t nArt, uint32_t nObject)
+{
+	if (m_nCapacity && m_PosX.size() >= m_nCapacity)
+	{
+		m_nExhausted++;
+		SSlotHandle none = { 0, 0 };
+		return none;
+	}
+
+	m_PosX.push_back(x);
+	m_PosY.push_back(y);
+	m_VelX.push_back(vx);
+	m_VelY.push_back(vy);
+	m_Scale.push_back(scale);
+	m_Art.push_back(nArt);
+	m_Object.push_back(nObject);
+
+	if (m_PosX.size() > m_nPeak)
+		m_nPeak = m_PosX.size();
+
+	return m_Slots.Insert();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Remove ()
+// Desc : Moves the last entity into index and drops the last slot.
+//-----------------------------------------------------------------------------
+void CEntityStore::Remove(size_t index)
+{
+	m_Slots.RemoveAt(index);
+
+	size_t last = m_PosX.size() - 1;
+	if (index != last)
+	{
+		m_PosX[index]	= m_PosX[last];
+		m_PosY[index]	= m_PosY[last];
+		m_VelX[index]	= m_VelX[last];
+		m_VelY[index]	= m_VelY[last];
+		m_Scale[index]	= m_Scale[last];
+		m_Art[index]	= m_Art[last];
+		m_Object[index]	= m_Object[last];
+	}
+
+	m_PosX.pop_back();
+	m_PosY.pop_back();
+	m_VelX.pop_back();
+	m_VelY.pop_back();
+	m_Scale.pop_back();
+	m_Art.pop_back();
+	m_Object.pop_back();
+}
+
+bool CEntityStore::Remove(SSlotHandle handle)
+{
+	size_t index = m_Slots.Find(handle);
+	if (index == SLOT_NONE)
+		return false;
+
+	Remove(index);
+	return true;
+}
+
+void CEntityStore::Clear()
+{
+	m_Slots.Clear();
+	m_PosX.clear();
+	m_PosY.clear();
+	m_VelX.clear();
+	m_VelY.clear();
+	m_Scale.clear();
+	m_Art.clear();
+	m_Object.clear();
+}
+
+void CEntityStore::Reserve(size_t count)
+{
+	m_Slots.Reserve(count);
+	m_PosX.reserve(count);
+	m_PosY.reserve(count);
+	m_VelX.reserve(count);
+	m_VelY.reserve(count);
+	m_Scale.reserve(count);
+	m_Art.reserve(count);
+	m_Object.reserve(count);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetCapacity ()
+// Desc : Reserves room for count entities, which is then all the store
+//		will hold. Slots are recycled, so a store that stays within its
+//		capacity never allocates again.
+//-----------------------------------------------------------------------------
+void CEntityStore::SetCapacity(size_t count)
+{
+	m_nCapacity = count;
+	Reserve(count);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Move ()
+// Desc : Two independent streaming loops the compiler can vectorise.
+//-----------------------------------------------------------------------------
+void CEntityStore::Move()
+{
+	size_t count = m_PosX.size();
+
+	float* x = m_PosX.data();
+	const float* vx = m_VelX.data();
+	for (size_t i = 0; i < count; i++)
+		x[i] += vx[i];
+
+	float* y = m_PosY.data();
+	const float* vy = m_VelY.data();
+	for (size_t i = 0; i < count; i++)
+		y[i] += vy[i];
+}
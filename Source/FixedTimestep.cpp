@@ -0,0 +1,62 @@
+//-----------------------------------------------------------------------------
+// File: FixedTimestep.cpp
+//
+// Desc: Fixed step simulation clock.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFixedTimestep Specific Includes
+//-----------------------------------------------------------------------------
+#include "FixedTimestep.h"
+#include <chrono>
+
+//-----------------------------------------------------------------------------
+// CFixedTimestep Member Functions
+//-----------------------------------------------------------------------------
+CFixedTimestep::CFixedTimestep()
+{
+	m_fStep		= SIM_TIMESTEP;
+	m_nMaxSteps	= SIM_MAX_STEPS;
+	Reset();
+}
+
+CFixedTimestep::~CFixedTimestep()
+{
+}
+
+void CFixedTimestep::Reset()
+{
+	m_fAccumulator	= 0.0;
+	m_fDropped		= 0.0;
+	m_nSteps		= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Advance ()
+// Desc : Negative times (a clock going backwards) count as nothing.
+//-----------------------------------------------------------------------------
+int CFixedTimestep::Advance(double fTimeElapsed)
+{
+	if (fTimeElapsed > 0.0)
+		m_fAccumulator += fTimeElapsed;
+
+	int nSteps = (int)(m_fAccumulator / m_fStep);
+	if (nSteps > m_nMaxSteps)
+	{
+		// Keep the fraction so the steps stay evenly spaced afterwards
+		double fOwed = m_fAccumulator - nSteps * m_fStep;
+		m_fDropped	   += (nSteps - m_nMaxSteps) * m_fStep;
+		m_fAccumulator	= fOwed + m_nMaxSteps * m_fStep;
+		nSteps			= m_nMaxSteps;
+	}
+
+	m_fAccumulator -= nSteps * m_fStep;
+	m_nSteps += nSteps;
+	return nSteps;
+}
+
+double CFixedTimestep::Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
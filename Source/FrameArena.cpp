@@ -0,0 +1,104 @@
+//-----------------------------------------------------------------------------
+// File: FrameArena.cpp
+//
+// Desc: Linear (bump) allocator for per frame data.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFrameArena Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameArena.h"
+#include "FrameBuffer.h"
+#include <string.h>
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// CFrameArena Member Functions
+//-----------------------------------------------------------------------------
+CFrameArena::CFrameArena(size_t capacity)
+{
+	m_pBlock		= (uint8_t*)AlignedAlloc(capacity);
+	m_nCapacity		= m_pBlock ? capacity : 0;
+	m_nOffset		= 0;
+	m_nUsed			= 0;
+	m_nPeak			= 0;
+	m_nOverflows	= 0;
+}
+
+CFrameArena::~CFrameArena()
+{
+	for (size_t i = 0; i < m_Overflow.size(); i++)
+		AlignedFree(m_Overflow[i]);
+
+	AlignedFree(m_pBlock);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Allocate ()
+// Desc : Bumps the offset, or takes a block of its own from the heap when
+//		the arena is full. alignment must be a power of two up to
+//		FRAMEBUFFER_ALIGN, the alignment of the block and of the extra
+//		ones. NULL when the heap has no room either.
+//-----------------------------------------------------------------------------
+void* CFrameArena::Allocate(size_t size, size_t alignment)
+{
+	assert(alignment && (alignment & (alignment - 1)) == 0 && alignment <= FRAMEBUFFER_ALIGN);
+
+	size_t offset = (m_nOffset + alignment - 1) & ~(alignment - 1);
+	size_t used = m_nUsed + size + (offset - m_nOffset);
+
+	void* p;
+	if (offset <= m_nCapacity && size <= m_nCapacity - offset)
+	{
+		m_nOffset = offset + size;
+		p = m_pBlock + offset;
+	}
+	else
+	{
+		// The block is sized to the peak at the next Reset()
+		p = AlignedAlloc(size ? size : 1, FRAMEBUFFER_ALIGN);
+		if (!p)
+			return NULL;
+
+		m_Overflow.push_back(p);
+		m_nOverflows++;
+	}
+
+	m_nUsed = used;
+	if (m_nUsed > m_nPeak)
+		m_nPeak = m_nUsed;
+	return p;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Takes back everything handed out since the last Reset().
+//-----------------------------------------------------------------------------
+void CFrameArena::Reset()
+{
+#ifdef _DEBUG
+	if (m_pBlock)
+		memset(m_pBlock, FRAMEARENA_POISON, m_nOffset);
+#endif
+
+	if (!m_Overflow.empty())
+	{
+		for (size_t i = 0; i < m_Overflow.size(); i++)
+			AlignedFree(m_Overflow[i]);
+		m_Overflow.clear();
+
+		// Room for the biggest frame so far, with some to spare
+		size_t capacity = m_nPeak + m_nPeak / 2;
+		uint8_t* pBlock = (uint8_t*)AlignedAlloc(capacity);
+		if (pBlock)
+		{
+			AlignedFree(m_pBlock);
+			m_pBlock	= pBlock;
+			m_nCapacity	= capacity;
+		}
+	}
+
+	m_nOffset	= 0;
+	m_nUsed		= 0;
+}
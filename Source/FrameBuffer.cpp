@@ -0,0 +1,154 @@
+//-----------------------------------------------------------------------------
+// File: FrameBuffer.cpp
+//
+// Desc: Portable 32-bit software framebuffer.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include "FrameBuffer.h"
+#include <stdlib.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : AlignedAlloc () / AlignedFree ()
+// Desc : Aligned heap allocation helpers.
+//-----------------------------------------------------------------------------
+void* AlignedAlloc(size_t size, size_t alignment)
+{
+#ifdef _MSC_VER
+	return _aligned_malloc(size, alignment);
+#else
+	void* p = NULL;
+	if (posix_memalign(&p, alignment, size) != 0) return NULL;
+	return p;
+#endif
+}
+
+void AlignedFree(void* p)
+{
+#ifdef _MSC_VER
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Member Functions
+//-----------------------------------------------------------------------------
+CFrameBuffer::CFrameBuffer()
+{
+	m_pPixels	= NULL;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_iPitch	= 0;
+	m_bOwner	= false;
+}
+
+CFrameBuffer::CFrameBuffer(int width, int height)
+{
+	m_pPixels	= NULL;
+	m_bOwner	= false;
+	Create(width, height);
+}
+
+CFrameBuffer::~CFrameBuffer()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates our own pixel memory. Every row starts on an aligned
+//		boundary so that the SIMD blitters can use aligned stores.
+//-----------------------------------------------------------------------------
+bool CFrameBuffer::Create(int width, int height)
+{
+	Release();
+
+	int rowBytes = width * (int)sizeof(uint32_t);
+	m_iPitch	= (int)((rowBytes + FRAMEBUFFER_ALIGN - 1) & ~(FRAMEBUFFER_ALIGN - 1));
+	m_iWidth	= width;
+	m_iHeight	= height;
+	m_pPixels	= (uint32_t*)AlignedAlloc((size_t)m_iPitch * height);
+	m_bOwner	= true;
+
+	if (!m_pPixels)
+	{
+		m_iWidth = m_iHeight = m_iPitch = 0;
+		return false;
+	}
+
+	memset(m_pPixels, 0, (size_t)m_iPitch * height);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Attach ()
+// Desc : Wraps pixel memory we do not own (for example the bits of a DIB
+//		section). The memory must outlive this object or be detached first.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Attach(uint32_t* pPixels, int width, int height, int pitch)
+{
+	Release();
+
+	m_pPixels	= pPixels;
+	m_iWidth	= width;
+	m_iHeight	= height;
+	m_iPitch	= pitch;
+	m_bOwner	= false;
+}
+
+void CFrameBuffer::Release()
+{
+	if (m_bOwner && m_pPixels)
+		AlignedFree(m_pPixels);
+
+	m_pPixels	= NULL;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+	m_iPitch	= 0;
+	m_bOwner	= false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Fills the whole surface with a single color.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Clear(uint32_t color)
+{
+	FillRect(0, 0, m_iWidth, m_iHeight, color);
+}
+
+//-----------------------------------------------------------------------------
+// Name : FillRect ()
+// Desc : Fills a rectangle, clipped against the surface edges. Only the
+//		first row is filled a pixel at a time; the rows below are copied
+//		from it, which works for any color (the clear color 0x00FFFFFF
+//		does not have all four bytes equal, so memset cannot fill it).
+//-----------------------------------------------------------------------------
+void CFrameBuffer::FillRect(int x, int y, int w, int h, uint32_t color)
+{
+	int x0 = x < 0 ? 0 : x;
+	int y0 = y < 0 ? 0 : y;
+	int x1 = x + w > m_iWidth ? m_iWidth : x + w;
+	int y1 = y + h > m_iHeight ? m_iHeight : y + h;
+
+	if (!m_pPixels || x0 >= x1 || y0 >= y1)
+		return;
+
+	const uint32_t* pFirst = Row(y0) + x0;
+	size_t nRowBytes = (size_t)(x1 - x0) * sizeof(uint32_t);
+
+	uint32_t* pDst = Row(y0) + x0;
+	for (int i = 0; i < x1 - x0; i++) pDst[i] = color;
+
+	for (int j = y0 + 1; j < y1; j++)
+		memcpy(Row(j) + x0, pFirst, nRowBytes);
+}
@@ -0,0 +1,981 @@
+//-----------------------------------------------------------------------------
+// File: GameWorld.cpp
+//
+// Desc: The game objects and rules, stepped without any platform code.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CGameWorld Specific Includes
+//-----------------------------------------------------------------------------
+#include "GameWorld.h"
+#include "FixedTimestep.h"
+#include "CBullet.h"
+#include <algorithm>
+#include <string.h>
+#include <chrono>
+#include <functional>
+#include <type_traits>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+struct SArtSource
+{
+	const char*	szFileName;
+	uint32_t	nKeyColor;		// Framebuffer layout, see PackPixel()
+	float		fScale;
+};
+
+// In EEntityArt order
+static const SArtSource g_ArtSources[ART_COUNT] =
+{
+	{ "data/bulletandmask.bmp",			0x00FF00FF, 0.1f },
+	{ "data/chickenbulletandmask.bmp",	0x00FF00FF, 0.1f },
+	{ "data/BulletBigBossAndMask.bmp",	0x00FF00FF, 0.1f },
+	{ "data/ChickenEnemy.bmp",			0x00000000, 0.5f },
+	{ "data/Health.bmp",				0x00FFFFFF, 1.0f },
+	{ "data/BigBossImgAndMask.bmp",		0x00FF00FF, 1.0f },
+};
+
+// FNV-1a over bytes
+static uint64_t HashBytes(uint64_t h, const void* pData, size_t nBytes)
+{
+	const uint8_t* p = (const uint8_t*)pData;
+	for (size_t i = 0; i < nBytes; i++)
+		h = (h ^ p[i]) * 0x100000001B3ULL;
+	return h;
+}
+
+// Types of the same size in every build. long, size_t and bool are not:
+// Win32 and 64 bit Linux builds must hash a state to the same value.
+template <typename T>
+struct SFixedWidth
+{
+	static const bool value = std::is_same<T, uint8_t>::value || std::is_same<T, uint16_t>::value
+		|| std::is_same<T, uint32_t>::value || std::is_same<T, int32_t>::value
+		|| std::is_same<T, float>::value || std::is_same<T, double>::value;
+};
+
+template <typename T>
+static uint64_t HashValues(uint64_t h, const T* pValues, size_t count = 1)
+{
+	static_assert(SFixedWidth<T>::value, "State hashes take fixed width fields only");
+	return HashBytes(h, pValues, count * sizeof(T));
+}
+
+static uint64_t HashStore(uint64_t h, const CEntityStore& store)
+{
+	uint32_t count = (uint32_t)store.Size();
+	h = HashValues(h, &count);
+	h = HashValues(h, store.PosX(), count);
+	h = HashValues(h, store.PosY(), count);
+	h = HashValues(h, store.VelX(), count);
+	h = HashValues(h, store.VelY(), count);
+	h = HashValues(h, store.Scale(), count);
+	return HashValues(h, store.Art(), count);
+}
+
+// Appends nBytes to a saved state
+static void Put(std::vector<uint8_t>& state, const void* pData, size_t nBytes)
+{
+	const uint8_t* p = (const uint8_t*)pData;
+	state.insert(state.end(), p, p + nBytes);
+}
+
+// Takes the next nBytes of a saved state, false when it ends first
+static bool Take(const uint8_t*& p, const uint8_t* pEnd, void* pData, size_t nBytes)
+{
+	if ((size_t)(pEnd - p) < nBytes)
+		return false;
+
+	memcpy(pData, p, nBytes);
+	p += nBytes;
+	return true;
+}
+
+static void PutStore(std::vector<uint8_t>& state, const CEntityStore& store)
+{
+	uint32_t count = (uint32_t)store.Size();
+	Put(state, &count, sizeof(count));
+	Put(state, store.PosX(), count * sizeof(float));
+	Put(state, store.PosY(), count * sizeof(float));
+	Put(state, store.VelX(), count * sizeof(float));
+	Put(state, store.VelY(), count * sizeof(float));
+	Put(state, store.Scale(), count * sizeof(float));
+	Put(state, store.Art(), count * sizeof(uint16_t));
+	Put(state, store.Object(), count * sizeof(uint32_t));
+}
+
+// The arrays are read in place and added an entity at a time
+static bool TakeStore(const uint8_t*& p, const uint8_t* pEnd, CEntityStore& store)
+{
+	uint32_t count;
+	if (!Take(p, pEnd, &count, sizeof(count)))
+		return false;
+
+	size_t nBytes = (size_t)count * (5 * sizeof(float) + sizeof(uint16_t) + sizeof(uint32_t));
+	if ((size_t)(pEnd - p) < nBytes || (store.GetCapacity() && count > store.GetCapacity()))
+		return false;
+
+	const uint8_t* pArrays[7];
+	pArrays[0] = p;
+	for (int i = 1; i < 5; i++)
+		pArrays[i] = pArrays[i - 1] + count * sizeof(float);
+	pArrays[5] = pArrays[4] + count * sizeof(float);
+	pArrays[6] = pArrays[5] + count * sizeof(uint16_t);
+
+	store.Clear();
+	for (uint32_t i = 0; i < count; i++)
+	{
+		float values[5];
+		uint16_t nArt;
+		uint32_t nObject;
+		for (int n = 0; n < 5; n++)
+			memcpy(&values[n], pArrays[n] + i * sizeof(float), sizeof(float));
+		memcpy(&nArt, pArrays[5] + i * sizeof(uint16_t), sizeof(nArt));
+		memcpy(&nObject, pArrays[6] + i * sizeof(uint32_t), sizeof(nObject));
+		if (nArt >= ART_COUNT)
+			return false;
+
+		store.Add(values[0], values[1], values[2], values[3], values[4], nArt, nObject);
+	}
+
+	p += nBytes;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// CGameWorld Member Functions
+//-----------------------------------------------------------------------------
+CGameWorld::CGameWorld()
+{
+	m_pPlayer			= NULL;
+	m_nStep				= 0;
+	m_iScore			= 0;
+	m_iKilledChickens	= 0;
+	m_iLevel			= 0;
+	m_fExplosionTime	= 0.0f;
+	m_bGameOver			= false;
+	m_bBruteForce		= false;
+	m_nSeed				= GAMEWORLD_DEFAULT_SEED;
+
+	SetBulletCapacity(PLAYER_BULLET_CAPACITY, ENEMY_BULLET_CAPACITY);
+
+	for (int i = 0; i < ART_COUNT; i++)
+	{
+		m_Art[i].pImage		= NULL;
+		m_Art[i].pDraw		= NULL;
+		m_Art[i].iWidth		= 0;
+		m_Art[i].iHeight	= 0;
+		m_Art[i].fScale		= 1.0f;
+	}
+}
+
+CGameWorld::~CGameWorld()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Init ()
+// Desc : Loads the entity images and creates the player and the first
+//		wave, the state a game starts in, with every random stream started
+//		from nSeed.
+//-----------------------------------------------------------------------------
+bool CGameWorld::Init(uint64_t nSeed)
+{
+	Release();
+
+	m_nSeed = nSeed;
+	for (int i = 0; i < RANDOM_STREAM_COUNT; i++)
+		m_Random[i].Seed(nSeed, i);
+
+	for (int i = 0; i < ART_COUNT; i++)
+	{
+		const SArtSource& source = g_ArtSources[i];
+		SEntityArt& art = m_Art[i];
+
+		art.pImage = g_AssetCache.Acquire(source.szFileName);
+		if (!art.pImage)
+			return false;
+
+		art.pImage->BuildColorKeyMask(source.nKeyColor);
+		art.pDraw	= source.fScale != 1.0f ? g_AssetCache.AcquireScaled(art.pImage, source.fScale, source.fScale) : art.pImage;
+		art.iWidth	= art.pImage->Width();
+		art.iHeight	= art.pImage->Height();
+		art.fScale	= source.fScale;
+		if (!art.pDraw)
+			return false;
+	}
+
+	m_pPlayer = new CPlayer();
+	m_pPlayer->Init();
+	m_pPlayer->Position() = Vec2(100, 400);
+
+	Spawn(m_Chickens, ART_CHICKEN, 600, 100, 1.0f, 0.0f);
+	Spawn(m_Health, ART_HEALTH, 300, 300, 0.0f, 0.0f);
+
+	m_nStep				= 0;
+	m_iScore			= 0;
+	m_iKilledChickens	= 0;
+	m_iLevel			= 0;
+	m_fExplosionTime	= 0.0f;
+	m_bGameOver			= false;
+
+	return true;
+}
+
+void CGameWorld::Release()
+{
+	if (m_pPlayer != NULL)
+	{
+		delete m_pPlayer;
+		m_pPlayer = NULL;
+	}
+
+	m_Bullets.Clear();
+	m_EnemyBullets.Clear();
+	m_Chickens.Clear();
+	m_Health.Clear();
+	m_Bosses.Clear();
+
+	for (int i = 0; i < ART_COUNT; i++)
+	{
+		if (m_Art[i].pDraw != m_Art[i].pImage)
+			g_AssetCache.Release(m_Art[i].pDraw);
+		g_AssetCache.Release(m_Art[i].pImage);
+		m_Art[i].pImage	= NULL;
+		m_Art[i].pDraw	= NULL;
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : Step ()
+// Desc : Advances the game world by one step: spawning, movement,
+//		collisions and then the input. Every kind of entity is a set of
+//		arrays, each pass below walks them front to back.
+//-----------------------------------------------------------------------------
+void CGameWorld::Step(const SGameInput& input)
+{
+	const float fTimeElapsed = (float)SIM_TIMESTEP;
+
+	m_nStep++;
+
+	if (m_Chickens.IsEmpty() && m_iLevel!=5) {
+		for (int i = 0; i < 4; ++i) {
+			float pos = 100.0f + i * 200.0f; // Adjust the spacing between chickens as needed
+			Spawn(m_Chickens, ART_CHICKEN, pos, 100.0f, 1.0f, 0.0f);
+		}
+	}
+
+
+	if (m_iLevel % 2 == 0 && m_Health.IsEmpty())
+	{
+		float x = m_Random[RANDOM_PICKUPS].NextFloat(0, 860);
+		float y = m_Random[RANDOM_PICKUPS].NextFloat(0, 860);
+		Spawn(m_Health, ART_HEALTH, x, y, 0.0f, 0.0f);
+	}
+
+	// The player's bullets against the chickens and the bosses
+	m_Bullets.Move();
+	CollideBullets(input.iWidth, input.iHeight);
+
+	// Theirs against the player, who is taken back to the start by the
+	// first one to hit
+	m_EnemyBullets.Move();
+	if (!m_pPlayer->IsExploding())
+	{
+		size_t hit = FindPlayerHit(m_EnemyBullets);
+		if (hit != SLOT_NONE)
+		{
+			m_pPlayer->Explode();
+			m_fExplosionTime = 0.0f;
+			m_pPlayer->Position() = Vec2(100, 400);
+			m_pPlayer->Velocity() = Vec2(0, 0);
+			m_EnemyBullets.Remove(hit);
+		}
+	}
+	for (size_t i = 0; i < m_EnemyBullets.Size(); )
+	{
+		if (IsOutside(m_EnemyBullets, i, input.iWidth, input.iHeight))
+			m_EnemyBullets.Remove(i);
+		else
+			i++;
+	}
+
+	// Chickens and bosses turn around near the edges
+	CEntityStore* pMovers[] = { &m_Chickens, &m_Bosses };
+	for (int n = 0; n < 2; n++)
+	{
+		CEntityStore& movers = *pMovers[n];
+		const float* x = movers.PosX();
+		float* vx = movers.VelX();
+		for (size_t i = 0; i < movers.Size(); i++)
+		{
+			if (x[i] > 700 && vx[i] > 0) vx[i] = -vx[i];
+			else if (x[i] < 100 && vx[i] < 0) vx[i] = -vx[i];
+		}
+		movers.Move();
+	}
+
+	Shoot(m_Chickens, ART_CHICKEN_BULLET);
+	Shoot(m_Bosses, ART_BOSS_BULLET);
+
+	m_Health.Move();
+	for (size_t i = 0; i < m_Health.Size(); )
+	{
+		if (HitsPlayer(m_Health, i) && !m_pPlayer->IsExploding())
+		{
+			m_pPlayer->AddLife();
+			m_Health.Remove(i);
+		}
+		else
+			i++;
+	}
+
+	if (!m_pPlayer->IsExploding() && m_pPlayer->GetLives() < 1)
+		m_bGameOver = true;
+	if (m_iKilledChickens == 1)
+		m_iLevel = 1;
+	if(m_iKilledChickens > 1)
+		m_iLevel = 1+ m_iKilledChickens / 4;
+	if (m_Bosses.IsEmpty()  && m_iLevel == 5)
+		Spawn(m_Bosses, ART_BOSS, 0.0f, 100.0f, 1.0f, 0.0f);
+
+	// Input gathered since the last step
+	m_pPlayer->Move(input.nDirection, input.iWidth, input.iHeight);
+
+	for (int n = input.nFire; n > 0; n--)
+	{
+		if (m_pPlayer->IsExploding()) break;
+
+		// Just right of the plane's center line, level with its center
+		const SEntityArt& art = m_Art[ART_BULLET];
+		const Vec2& position = m_pPlayer->Position();
+		float x = (float)(position.x + m_pPlayer->Size().x / 2 + (round(art.iWidth * art.fScale) / 2));
+		Spawn(m_Bullets, ART_BULLET, x, (float)position.y, 0.0f, -1.0f);
+	}
+
+	m_pPlayer->Update(fTimeElapsed);
+
+	// The explosion plays at 20 frames a second
+	if (m_pPlayer->IsExploding())
+	{
+		for (m_fExplosionTime += fTimeElapsed; m_fExplosionTime >= 0.05f; m_fExplosionTime -= 0.05f)
+			if (!m_pPlayer->AdvanceExplosion())
+				break;
+	}
+
+	// Nothing of this step's scratch data outlives it
+	m_StepArena.Reset();
+}
+
+//-----------------------------------------------------------------------------
+// Name : CollideBullets () (Private)
+// Desc : Finds what the player's bullets hit on their way through this
+//		step, then removes it all. A bullet takes at most one chicken and
+//		one boss, the first of each it reaches, and a target hit by an
+//		earlier bullet is not hit again. Chickens and then bosses make one
+//		range of target indices, which the target grid narrows down to the
+//		ones near the path of each bullet, or which is tried whole when
+//		collisions are brute force. The lists live in the step arena.
+//-----------------------------------------------------------------------------
+void CGameWorld::CollideBullets(int width, int height)
+{
+	CArenaAllocator<uint32_t> alloc(m_StepArena);
+	ArenaVector<uint32_t> deadBullets(alloc), deadChickens(alloc), deadBosses(alloc);
+	ArenaVector<uint8_t> chickenHit(m_Chickens.Size(), 0, alloc), bossHit(m_Bosses.Size(), 0, alloc);
+
+	size_t nChickens = m_Chickens.Size();
+	size_t nTargets = nChickens + m_Bosses.Size();
+	ArenaVector<uint32_t> everyTarget(alloc);
+
+	if (m_bBruteForce)
+	{
+		everyTarget.resize(nTargets);
+		for (size_t j = 0; j < nTargets; j++)
+			everyTarget[j] = (uint32_t)j;
+	}
+	else
+	{
+		ArenaVector<SAabb> boxes(nTargets, SAabb(), CArenaAllocator<SAabb>(m_StepArena));
+		for (size_t j = 0; j < nChickens; j++)
+			boxes[j] = GetDrawBox(m_Chickens, j);
+		for (size_t j = nChickens; j < nTargets; j++)
+			boxes[j] = GetDrawBox(m_Bosses, j - nChickens);
+		m_TargetGrid.Build(boxes.data(), nTargets);
+	}
+
+	for (size_t i = 0; i < m_Bullets.Size(); i++)
+	{
+		const uint32_t* pTargets = everyTarget.data();
+		size_t nCandidates = everyTarget.size();
+		if (!m_bBruteForce && nTargets)
+		{
+			SAabb path = SweptBounds(GetSweepBox(m_Bullets, i), m_Bullets.VelX()[i], m_Bullets.VelY()[i]);
+			const std::vector<uint32_t>& candidates = m_TargetGrid.Query(path);
+			pTargets = candidates.data();
+			nCandidates = candidates.size();
+		}
+
+		// Earliest of each kind, the lower index on a tie
+		size_t chicken = SLOT_NONE, boss = SLOT_NONE;
+		float tChicken = INFINITY, tBoss = INFINITY;
+		for (size_t k = 0; k < nCandidates; k++)
+		{
+			size_t j = pTargets[k];
+			float t;
+			if (j < nChickens)
+			{
+				if (!chickenHit[j] && BulletHits(i, m_Chickens, j, t) && t < tChicken)
+				{
+					chicken = j;
+					tChicken = t;
+				}
+			}
+			else
+			{
+				j -= nChickens;
+				if (!bossHit[j] && BulletHits(i, m_Bosses, j, t) && t < tBoss)
+				{
+					boss = j;
+					tBoss = t;
+				}
+			}
+		}
+
+		if (chicken != SLOT_NONE)
+		{
+			chickenHit[chicken] = 1;
+			deadChickens.push_back((uint32_t)chicken);
+			m_iScore += 100;
+			m_iKilledChickens++;
+		}
+		if (boss != SLOT_NONE)
+		{
+			bossHit[boss] = 1;
+			deadBosses.push_back((uint32_t)boss);
+			m_iScore += 500;
+			m_iKilledChickens++;
+		}
+
+		if (IsOutside(m_Bullets, i, width, height) || chicken != SLOT_NONE || boss != SLOT_NONE)
+			deadBullets.push_back((uint32_t)i);
+	}
+
+	RemoveAll(m_Bullets, deadBullets);
+	RemoveAll(m_Chickens, deadChickens);
+	RemoveAll(m_Bosses, deadBosses);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveAll () (Private, Static)
+// Desc : Highest index first, so the entity moved into each hole is one
+//		that stays.
+//-----------------------------------------------------------------------------
+void CGameWorld::RemoveAll(CEntityStore& store, ArenaVector<uint32_t>& indices)
+{
+	std::sort(indices.begin(), indices.end(), std::greater<uint32_t>());
+	for (size_t i = 0; i < indices.size(); i++)
+		store.Remove(indices[i]);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SaveState ()
+// Desc : Fixed size fields first, then each store as its arrays. Counters
+//		are written at a set width, so a state does not depend on the size
+//		of long. state is cleared first and keeps its capacity, saving into
+//		the same vector again does not allocate.
+//-----------------------------------------------------------------------------
+void CGameWorld::SaveState(std::vector<uint8_t>& state) const
+{
+	state.clear();
+
+	uint32_t nStep = (uint32_t)m_nStep;
+	int32_t counters[3] = { m_iScore, m_iKilledChickens, m_iLevel };
+	uint8_t bGameOver = m_bGameOver ? 1 : 0;
+	Put(state, &m_nSeed, sizeof(m_nSeed));
+	Put(state, &nStep, sizeof(nStep));
+	Put(state, counters, sizeof(counters));
+	Put(state, &m_fExplosionTime, sizeof(m_fExplosionTime));
+	Put(state, &bGameOver, sizeof(bGameOver));
+
+	for (int i = 0; i < RANDOM_STREAM_COUNT; i++)
+	{
+		uint32_t random[4];
+		m_Random[i].GetState(random);
+		Put(state, random, sizeof(random));
+	}
+
+	SPlayerState player;
+	m_pPlayer->GetState(player);
+	Put(state, &player, sizeof(player));
+
+	PutStore(state, m_Bullets);
+	PutStore(state, m_EnemyBullets);
+	PutStore(state, m_Chickens);
+	PutStore(state, m_Health);
+	PutStore(state, m_Bosses);
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadState ()
+// Desc : The world is left as it was saved, or, when the bytes are not a
+//		whole state, partly loaded and false is returned; Init() it again
+//		then.
+//-----------------------------------------------------------------------------
+bool CGameWorld::LoadState(const uint8_t* pState, size_t nBytes)
+{
+	if (!m_pPlayer)
+		return false;
+
+	const uint8_t* p = pState;
+	const uint8_t* pEnd = pState + nBytes;
+
+	uint64_t nSeed;
+	uint32_t nStep;
+	int32_t counters[3];
+	uint8_t bGameOver;
+	float fExplosionTime;
+	if (!Take(p, pEnd, &nSeed, sizeof(nSeed)) || !Take(p, pEnd, &nStep, sizeof(nStep))
+		|| !Take(p, pEnd, counters, sizeof(counters)) || !Take(p, pEnd, &fExplosionTime, sizeof(fExplosionTime))
+		|| !Take(p, pEnd, &bGameOver, sizeof(bGameOver)))
+		return false;
+
+	for (int i = 0; i < RANDOM_STREAM_COUNT; i++)
+	{
+		uint32_t random[4];
+		if (!Take(p, pEnd, random, sizeof(random)) || !m_Random[i].SetState(random))
+			return false;
+	}
+
+	SPlayerState player;
+	if (!Take(p, pEnd, &player, sizeof(player)))
+		return false;
+	m_pPlayer->SetState(player);
+
+	if (!TakeStore(p, pEnd, m_Bullets) || !TakeStore(p, pEnd, m_EnemyBullets) || !TakeStore(p, pEnd, m_Chickens)
+		|| !TakeStore(p, pEnd, m_Health) || !TakeStore(p, pEnd, m_Bosses) || p != pEnd)
+		return false;
+
+	m_nSeed				= nSeed;
+	m_nStep				= nStep;
+	m_iScore			= counters[0];
+	m_iKilledChickens	= counters[1];
+	m_iLevel			= counters[2];
+	m_fExplosionTime	= fExplosionTime;
+	m_bGameOver			= bGameOver != 0;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStateHash ()
+// Desc : What SaveState() keeps but the seed, which only the random
+//		streams depend on, and the object ids: the counters, the stream
+//		states, the player field by field (its struct has padding) and
+//		every store, values as stored. Two worlds that hash the same will
+//		step the same from here on.
+//-----------------------------------------------------------------------------
+uint64_t CGameWorld::GetStateHash() const
+{
+	uint64_t h = 0xCBF29CE484222325ULL;
+
+	// At set widths, like SaveState()
+	uint32_t nStep = (uint32_t)m_nStep;
+	int32_t counters[3] = { m_iScore, m_iKilledChickens, m_iLevel };
+	uint8_t bGameOver = m_bGameOver ? 1 : 0;
+	h = HashValues(h, &nStep);
+	h = HashValues(h, counters, 3);
+	h = HashValues(h, &m_fExplosionTime);
+	h = HashValues(h, &bGameOver);
+
+	for (int i = 0; i < RANDOM_STREAM_COUNT; i++)
+	{
+		uint32_t random[4];
+		m_Random[i].GetState(random);
+		h = HashValues(h, random, 4);
+	}
+
+	if (m_pPlayer)
+	{
+		SPlayerState player;
+		m_pPlayer->GetState(player);
+		h = HashValues(h, &player.fX);
+		h = HashValues(h, &player.fY);
+		h = HashValues(h, &player.fVelX);
+		h = HashValues(h, &player.fVelY);
+		h = HashValues(h, &player.fExplosionX);
+		h = HashValues(h, &player.fExplosionY);
+		h = HashValues(h, &player.fTimer);
+		h = HashValues(h, &player.iSpeedState);
+		h = HashValues(h, &player.iLives);
+		h = HashValues(h, &player.iExplosionFrame);
+		h = HashValues(h, &player.bExplosion);
+	}
+
+	h = HashStore(h, m_Bullets);
+	h = HashStore(h, m_EnemyBullets);
+	h = HashStore(h, m_Chickens);
+	h = HashStore(h, m_Health);
+	return HashStore(h, m_Bosses);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Record ()
+// Desc : Records every sprite of the world into a draw list.
+//-----------------------------------------------------------------------------
+void CGameWorld::Record(CDrawList& drawList)
+{
+	drawList.Begin();
+
+	m_pPlayer->Draw(drawList);
+
+	Record(drawList, m_Bullets, DRAWLAYER_BULLETS);
+	Record(drawList, m_EnemyBullets, DRAWLAYER_BULLETS);
+	Record(drawList, m_Chickens, DRAWLAYER_ENEMIES);
+	Record(drawList, m_Health, DRAWLAYER_PICKUPS);
+	Record(drawList, m_Bosses, DRAWLAYER_BOSS);
+}
+
+unsigned int CGameWorld::TakeSounds()
+{
+	return m_pPlayer ? m_pPlayer->TakeSounds() : 0;
+}
+
+void CGameWorld::SetBulletCapacity(size_t nPlayer, size_t nEnemy)
+{
+	m_Bullets.SetCapacity(nPlayer);
+	m_EnemyBullets.SetCapacity(nEnemy);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Spawn () (Private)
+// Desc : Adds an entity at its art's scale, with a new object id.
+//-----------------------------------------------------------------------------
+SSlotHandle CGameWorld::Spawn(CEntityStore& store, EEntityArt eArt, float x, float y, float vx, float vy)
+{
+	return store.Add(x, y, vx, vy, m_Art[eArt].fScale, (uint16_t)eArt, Sprite::newId());
+}
+
+//-----------------------------------------------------------------------------
+// Name : Shoot () (Private)
+// Desc : Each shooter fires downwards with ENEMY_FIRE_CHANCE, from half a
+//		bullet below its center. The rolls of all of them are drawn at
+//		once into the step arena.
+//-----------------------------------------------------------------------------
+void CGameWorld::Shoot(const CEntityStore& shooters, EEntityArt eBullet)
+{
+	ArenaVector<float> roll(shooters.Size(), 0.0f, CArenaAllocator<float>(m_StepArena));
+	m_Random[RANDOM_FIRE].FillFloat(roll.data(), roll.size());
+
+	const float* x = shooters.PosX();
+	const float* y = shooters.PosY();
+	for (size_t i = 0; i < shooters.Size(); i++)
+	{
+		if (roll[i] < ENEMY_FIRE_CHANCE)
+			Spawn(m_EnemyBullets, eBullet, x[i], y[i] + (float)(round(m_Art[eBullet].iHeight * 1.0f) / 2), 0.0f, 1.0f);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : BulletHits () (Private)
+// Desc : Whether the pixels of the player's bullet meet the target's
+//		anywhere along the bullet's path this step, and when. The target
+//		stands where it is drawn. The boxes are swept first, the masks are
+//		only ANDed over the part of the path where they overlap.
+//-----------------------------------------------------------------------------
+bool CGameWorld::BulletHits(size_t bullet, const CEntityStore& targets, size_t target, float& tHit) const
+{
+	SAabb targetBox = GetDrawBox(targets, target);
+	float tEnter, tExit;
+	if (!SweepTimes(targetBox, GetSweepBox(m_Bullets, bullet), m_Bullets.VelX()[bullet], m_Bullets.VelY()[bullet], tEnter, tExit))
+		return false;
+
+	return SweepHits(m_Bullets, bullet, tEnter, tExit, GetHitMask(targets, target), (int)targetBox.fMinX, (int)targetBox.fMinY, tHit);
+}
+
+// Nothing of the entity as drawn is left on the field
+bool CGameWorld::IsOutside(const CEntityStore& store, size_t index, int width, int height) const
+{
+	SAabb box = GetDrawBox(store, index);
+	return box.fMaxX < 0.0f || box.fMinX >= width || box.fMaxY < 0.0f || box.fMinY >= height;
+}
+
+bool CGameWorld::HitsPlayer(const CEntityStore& store, size_t index) const
+{
+	SAabb box = GetDrawBox(store, index);
+	return m_pPlayer->Intersects(GetHitMask(store, index), (int)box.fMinX, (int)box.fMinY);
+}
+
+// BulletHits() against the player, whose drawn box is player
+bool CGameWorld::SweepsPlayer(const CEntityStore& store, size_t index, const SAabb& player, float& tHit) const
+{
+	float tEnter, tExit;
+	if (!SweepTimes(player, GetSweepBox(store, index), store.VelX()[index], store.VelY()[index], tEnter, tExit))
+		return false;
+
+	return SweepHits(store, index, tEnter, tExit, *m_pPlayer->GetHitMask(), (int)player.fMinX, (int)player.fMinY, tHit);
+}
+
+//-----------------------------------------------------------------------------
+// Name : FindPlayerHit () (Private)
+// Desc : The entity of store that hits the player first on its way
+//		through this step, the lower index on a tie, or SLOT_NONE. One box
+//		against all of store moving is what the CAabbBatch sweep does:
+//		the edges go into arrays in the step arena, the kernel marks the
+//		paths that cross the player's box with their time of impact, and
+//		only those that could come before the best hit so far get their
+//		masks tested.
+//-----------------------------------------------------------------------------
+size_t CGameWorld::FindPlayerHit(const CEntityStore& store)
+{
+	if (!m_pPlayer->GetHitMask())
+		return SLOT_NONE;
+
+	size_t count = store.Size();
+	SAtlasRect rc = m_pPlayer->GetHitRect();
+	SAabb player = { (float)rc.x, (float)rc.y, (float)(rc.x + rc.w - 1), (float)(rc.y + rc.h - 1) };
+
+	size_t hit = SLOT_NONE;
+	float tFirst = INFINITY, t;
+
+	if (m_bBruteForce)
+	{
+		for (size_t i = 0; i < count; i++)
+			if (SweepsPlayer(store, i, player, t) && t < tFirst)
+			{
+				hit = i;
+				tFirst = t;
+			}
+		return hit;
+	}
+
+	CArenaAllocator<float> alloc(m_StepArena);
+	ArenaVector<float> minX(count, 0.0f, alloc), minY(count, 0.0f, alloc), maxX(count, 0.0f, alloc), maxY(count, 0.0f, alloc);
+	ArenaVector<float> time(count, 0.0f, alloc);
+	ArenaVector<uint64_t> mask((count + 63) / 64, 0, CArenaAllocator<uint64_t>(m_StepArena));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		SAabb box = GetSweepBox(store, i);
+		minX[i] = box.fMinX;
+		minY[i] = box.fMinY;
+		maxX[i] = box.fMaxX;
+		maxY[i] = box.fMaxY;
+	}
+
+	SAabbArrays boxes = { minX.data(), minY.data(), maxX.data(), maxY.data() };
+	if (!CAabbBatch::Sweep(player, boxes, store.VelX(), store.VelY(), count, time.data(), mask.data()))
+		return SLOT_NONE;
+
+	// Words without a bit are passed over at once. The boxes meet no later
+	// than the pixels, so a path reaching the box at or after the best hit
+	// cannot beat it.
+	for (size_t w = 0; w < mask.size(); w++)
+		for (size_t j = 0; j < 64 && (mask[w] >> j); j++)
+		{
+			size_t i = w * 64 + j;
+			if (((mask[w] >> j) & 1) && time[i] < tFirst && SweepsPlayer(store, i, player, t) && t < tFirst)
+			{
+				hit = i;
+				tFirst = t;
+			}
+		}
+
+	return hit;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SweepHits () (Private)
+// Desc : The entity moved by its velocity this step, so at time t of the
+//		step it was drawn at GetDrawBox(t). Between tEnter and tExit, cut
+//		to the step, it is put down once per pixel moved along its longer
+//		axis, the end included, and its mask tested against mask drawn at
+//		(x, y). tHit is the first time they meet. Without motion this is
+//		the one test of where the entity is now.
+//-----------------------------------------------------------------------------
+bool CGameWorld::SweepHits(const CEntityStore& store, size_t index, float tEnter, float tExit,
+						   const CHitMask& mask, int x, int y, float& tHit) const
+{
+	float tStart = tEnter > 0.0f ? tEnter : 0.0f;
+	float tEnd = tExit < 1.0f ? tExit : 1.0f;
+	float vx = fabsf(store.VelX()[index]), vy = fabsf(store.VelY()[index]);
+	int nSteps = (int)ceilf((tEnd - tStart) * (vx > vy ? vx : vy));
+
+	const CHitMask& own = GetHitMask(store, index);
+	for (int k = 0; k <= nSteps; k++)
+	{
+		float t = k == nSteps ? tEnd : tStart + (tEnd - tStart) * k / nSteps;
+		SAabb box = GetDrawBox(store, index, t);
+		if (CHitMask::Overlap(own, (int)box.fMinX, (int)box.fMinY, mask, x, y))
+		{
+			tHit = t;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetDrawBox () (Private)
+// Desc : The pixels Record() draws the entity over, first and last pixel
+//		included: the pre-scaled image, its upper-left corner half the
+//		unscaled image up and left of the stored center. At t short of
+//		1 the center is taken back along this step's motion.
+//-----------------------------------------------------------------------------
+SAabb CGameWorld::GetDrawBox(const CEntityStore& store, size_t index, float t) const
+{
+	const SEntityArt& art = m_Art[store.Art()[index]];
+	float fBack = 1.0f - t;
+	int x = (int)(store.PosX()[index] - store.VelX()[index] * fBack) - art.iWidth / 2;
+	int y = (int)(store.PosY()[index] - store.VelY()[index] * fBack) - art.iHeight / 2;
+
+	SAabb box = { (float)x, (float)y, (float)(x + art.pDraw->Width() - 1), (float)(y + art.pDraw->Height() - 1) };
+	return box;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetSweepBox () (Private)
+// Desc : The box to sweep along this step's motion: the draw box at its
+//		start, grown all round because the drawn corner is the center cut
+//		to whole pixels and strays from the straight path. Less than one
+//		pixel on either side of 0, less than two across it, where (int)
+//		cuts toward 0 from both sides.
+//-----------------------------------------------------------------------------
+SAabb CGameWorld::GetSweepBox(const CEntityStore& store, size_t index) const
+{
+	SAabb box = GetDrawBox(store, index, 0.0f);
+	box.fMinX -= 2.0f;
+	box.fMinY -= 2.0f;
+	box.fMaxX += 2.0f;
+	box.fMaxY += 2.0f;
+	return box;
+}
+
+const CHitMask& CGameWorld::GetHitMask(const CEntityStore& store, size_t index) const
+{
+	return m_Art[store.Art()[index]].pDraw->HitMask();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Record () (Private)
+// Desc : Draws like Sprite::draw(), centered on the unscaled image size.
+//-----------------------------------------------------------------------------
+void CGameWorld::Record(CDrawList& drawList, const CEntityStore& store, EDrawLayer eLayer) const
+{
+	const float* x = store.PosX();
+	const float* y = store.PosY();
+	const uint16_t* artIndex = store.Art();
+	const uint32_t* object = store.Object();
+
+	for (size_t i = 0; i < store.Size(); i++)
+	{
+		const SEntityArt& art = m_Art[artIndex[i]];
+		drawList.Add(eLayer, art.pDraw, (int)x[i] - art.iWidth / 2, (int)y[i] - art.iHeight / 2, 1.0f, 1.0f, -1, object[i]);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureBulletUpdate () (Static)
+// Desc : Moves count bullets iterations times in both layouts: heap
+//		allocated CBullet objects, each with its own Sprite, and one
+//		CEntityStore. Both end on the same positions.
+//-----------------------------------------------------------------------------
+bool CGameWorld::MeasureBulletUpdate(int count, int iterations, double& msObjects, double& msArrays)
+{
+	std::vector<CBullet*> objects;
+	CEntityStore store;
+	store.Reserve(count);
+
+	for (int i = 0; i < count; i++)
+	{
+		float x = (float)(i % 800), y = (float)(i / 800);
+		float vx = (float)(i % 3 - 1), vy = -1.0f;
+
+		CBullet* bullet = new CBullet(Vec2(vx, vy));
+		bullet->SetPosition(x, y);
+		objects.push_back(bullet);
+		store.Add(x, y, vx, vy, 0.1f, ART_BULLET, 0);
+	}
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int n = 0; n < iterations; n++)
+		for (size_t i = 0; i < objects.size(); i++)
+			objects[i]->Tick((float)SIM_TIMESTEP);
+	msObjects = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+	start = std::chrono::high_resolution_clock::now();
+	for (int n = 0; n < iterations; n++)
+		store.Move();
+	msArrays = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+	bool bMatch = true;
+	for (size_t i = 0; i < objects.size(); i++)
+	{
+		const Vec2& position = objects[i]->m_pSprite->mPosition;
+		if ((float)position.x != store.PosX()[i] || (float)position.y != store.PosY()[i])
+			bMatch = false;
+		delete objects[i];
+	}
+
+	return bMatch;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureBroadphase () (Static)
+// Desc : Scatters bullet sized and chicken sized boxes over a square field
+//		the targets cover about half of, and finds every overlapping pair,
+//		once by testing them all and once through a grid over the targets.
+//		Both must find the same pairs.
+//-----------------------------------------------------------------------------
+bool CGameWorld::MeasureBroadphase(int bullets, int targets, int iterations, double& msBruteForce, double& msGrid)
+{
+	std::vector<SAabb> bulletBoxes(bullets), targetBoxes(targets);
+	uint32_t nField = (uint32_t)sqrt(targets * 141.0 * 140.0 * 2.0) + 1;
+	uint32_t seed = 12345;
+	for (int i = 0; i < bullets + targets; i++)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		float x = (float)((seed >> 8) % nField);
+		seed = seed * 1664525u + 1013904223u;
+		float y = (float)((seed >> 8) % nField);
+
+		SAabb box = { x, y, x + (i < bullets ? 13.0f : 141.0f), y + (i < bullets ? 13.0f : 140.0f) };
+		if (i < bullets)
+			bulletBoxes[i] = box;
+		else
+			targetBoxes[i - bullets] = box;
+	}
+
+	uint64_t nBruteForce = 0, nGrid = 0;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (int n = 0; n < iterations; n++)
+	{
+		nBruteForce = 0;
+		for (int i = 0; i < bullets; i++)
+			for (int j = 0; j < targets; j++)
+				if (Overlaps(bulletBoxes[i], targetBoxes[j]))
+					nBruteForce += (uint64_t)i * targets + j + 1;
+	}
+	msBruteForce = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+	CSpatialGrid grid;
+	start = std::chrono::high_resolution_clock::now();
+	for (int n = 0; n < iterations; n++)
+	{
+		nGrid = 0;
+		grid.Build(targetBoxes.data(), targetBoxes.size());
+		for (int i = 0; i < bullets; i++)
+		{
+			const std::vector<uint32_t>& candidates = grid.Query(bulletBoxes[i]);
+			for (size_t k = 0; k < candidates.size(); k++)
+				nGrid += (uint64_t)i * targets + candidates[k] + 1;
+		}
+	}
+	msGrid = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() / iterations;
+
+	return nBruteForce == nGrid;
+}
@@ -0,0 +1,149 @@
+//-----------------------------------------------------------------------------
+// File: HitMask.cpp
+//
+// Desc: Packed one bit per pixel coverage masks.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CHitMask Specific Includes
+//-----------------------------------------------------------------------------
+#include "HitMask.h"
+
+//-----------------------------------------------------------------------------
+// CHitMask Member Functions
+//-----------------------------------------------------------------------------
+CHitMask::CHitMask()
+{
+	m_nWords	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+}
+
+CHitMask::~CHitMask()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Sets the bit of every pixel with a non zero alpha.
+//-----------------------------------------------------------------------------
+bool CHitMask::Build(const CFrameBuffer& image)
+{
+	Release();
+
+	if (!image.IsValid())
+		return false;
+
+	m_iWidth	= image.Width();
+	m_iHeight	= image.Height();
+	m_nWords	= (m_iWidth + 63) / 64;
+	m_Bits.assign((size_t)m_nWords * m_iHeight, 0);
+
+	for (int y = 0; y < m_iHeight; y++)
+	{
+		const uint32_t* pSrc = image.Row(y);
+		uint64_t* pRow = &m_Bits[0] + (size_t)y * m_nWords;
+		for (int x = 0; x < m_iWidth; x++)
+			if (pSrc[x] >> 24)
+				pRow[x >> 6] |= 1ULL << (x & 63);
+	}
+
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildScaled ()
+// Desc : Pixel x of a row samples base pixel (x * step) >> 16, step being
+//		the 16.16 ratio of the widths, and rows alike.
+//-----------------------------------------------------------------------------
+bool CHitMask::BuildScaled(const CHitMask& base, int width, int height)
+{
+	Release();
+
+	if (!base.IsValid() || width <= 0 || height <= 0)
+		return false;
+
+	uint32_t stepX = ((uint32_t)base.m_iWidth << 16) / (uint32_t)width;
+	uint32_t stepY = ((uint32_t)base.m_iHeight << 16) / (uint32_t)height;
+
+	m_iWidth	= width;
+	m_iHeight	= height;
+	m_nWords	= (m_iWidth + 63) / 64;
+	m_Bits.assign((size_t)m_nWords * m_iHeight, 0);
+
+	for (int y = 0; y < m_iHeight; y++)
+	{
+		int sy = (int)(((uint32_t)y * stepY) >> 16);
+		uint64_t* pRow = &m_Bits[0] + (size_t)y * m_nWords;
+
+		uint32_t fx = 0;
+		for (int x = 0; x < m_iWidth; x++, fx += stepX)
+			if (base.Test((int)(fx >> 16), sy))
+				pRow[x >> 6] |= 1ULL << (x & 63);
+	}
+
+	return true;
+}
+
+void CHitMask::Release()
+{
+	m_Bits.clear();
+	m_nWords	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Overlap () (Static)
+// Desc : Walks the rows the two images share and, across each, ANDs 64
+//		pixels of one with the 64 pixels of the other that land on the
+//		same screen columns. The last step of a row is cut to the columns
+//		still shared. Returns at the first common pixel.
+//-----------------------------------------------------------------------------
+bool CHitMask::Overlap(const CHitMask& a, int ax, int ay, const CHitMask& b, int bx, int by)
+{
+	if (!a.IsValid() || !b.IsValid())
+		return false;
+
+	int x0 = ax > bx ? ax : bx;
+	int y0 = ay > by ? ay : by;
+	int x1 = ax + a.m_iWidth < bx + b.m_iWidth ? ax + a.m_iWidth : bx + b.m_iWidth;
+	int y1 = ay + a.m_iHeight < by + b.m_iHeight ? ay + a.m_iHeight : by + b.m_iHeight;
+	if (x0 >= x1 || y0 >= y1)
+		return false;
+
+	for (int y = y0; y < y1; y++)
+	{
+		const uint64_t* pRowA = a.Row(y - ay);
+		const uint64_t* pRowB = b.Row(y - by);
+
+		for (int x = x0; x < x1; x += 64)
+		{
+			uint64_t bits = a.GetBits(pRowA, x - ax) & b.GetBits(pRowB, x - bx);
+			if (x1 - x < 64)
+				bits &= (1ULL << (x1 - x)) - 1;
+			if (bits)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBits () (Private)
+// Desc : The 64 pixels of a row starting at x, which need not be on a word
+//		boundary. Pixels past the width read as clear.
+//-----------------------------------------------------------------------------
+uint64_t CHitMask::GetBits(const uint64_t* pRow, int x) const
+{
+	int word = x >> 6, shift = x & 63;
+
+	uint64_t bits = pRow[word] >> shift;
+	if (shift && word + 1 < m_nWords)
+		bits |= pRow[word + 1] << (64 - shift);
+
+	return bits;
+}
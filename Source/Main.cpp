@@ -32,6 +32,15 @@ int WINAPI WinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmdLi
 	// initialize global instance
 	g_hInst = hInstance;
 
+	// "-replay <file>" plays a recorded session back instead of a game
+	if (_tcsncmp( lpCmdLine, _T("-replay "), 8 ) == 0)
+	{
+		LPTSTR lpFileName = lpCmdLine + 8;
+		while (*lpFileName == _T(' ') || *lpFileName == _T('"')) lpFileName++;
+		for (LPTSTR p = lpFileName + _tcslen(lpFileName); p > lpFileName && (p[-1] == _T(' ') || p[-1] == _T('"')); ) *--p = 0;
+		return CGameApp::RunReplay( lpFileName );
+	}
+
 	// Initialise the engine.
 	if (!g_App.InitInstance( lpCmdLine, iCmdShow )) return 1;
 	
@@ -0,0 +1,135 @@
+//-----------------------------------------------------------------------------
+// File: MappedFile.cpp
+//
+// Desc: Mapping files into memory, Win32 and POSIX.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CMappedFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// CMappedFile Member Functions
+//-----------------------------------------------------------------------------
+CMappedFile::CMappedFile()
+{
+	m_pData		= NULL;
+	m_nSize		= 0;
+	m_bOpen		= false;
+	m_hFile		= NULL;
+	m_hMapping	= NULL;
+}
+
+CMappedFile::~CMappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+bool CMappedFile::Open(const char* szFileName)
+{
+	Close();
+
+	HANDLE hFile = CreateFileA(szFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(hFile, &size) || (uint64_t)size.QuadPart > (size_t)-1)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+
+	m_hFile	= hFile;
+	m_nSize	= (size_t)size.QuadPart;
+	m_bOpen	= true;
+
+	// A mapping of nothing cannot be made, an empty file has no data
+	if (m_nSize == 0)
+		return true;
+
+	m_hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (m_hMapping)
+		m_pData = (const uint8_t*)MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!m_pData)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (m_pData)
+		UnmapViewOfFile(m_pData);
+	if (m_hMapping)
+		CloseHandle(m_hMapping);
+	if (m_hFile)
+		CloseHandle(m_hFile);
+
+	m_pData		= NULL;
+	m_nSize		= 0;
+	m_bOpen		= false;
+	m_hFile		= NULL;
+	m_hMapping	= NULL;
+}
+#else
+bool CMappedFile::Open(const char* szFileName)
+{
+	Close();
+
+	int fd = open(szFileName, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		close(fd);
+		return false;
+	}
+
+	m_nSize	= (size_t)st.st_size;
+	m_bOpen	= true;
+
+	if (m_nSize)
+	{
+		void* pData = mmap(NULL, m_nSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pData == MAP_FAILED)
+		{
+			close(fd);
+			Close();
+			return false;
+		}
+		m_pData = (const uint8_t*)pData;
+	}
+
+	// The mapping holds the file open on its own
+	close(fd);
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (m_pData)
+		munmap((void*)m_pData, m_nSize);
+
+	m_pData		= NULL;
+	m_nSize		= 0;
+	m_bOpen		= false;
+}
+#endif
@@ -0,0 +1,138 @@
+//-----------------------------------------------------------------------------
+// File: Random.cpp
+//
+// Desc: Seeding, stream jumps and batched draws of CRandom.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRandom Specific Includes
+//-----------------------------------------------------------------------------
+#include "Random.h"
+
+//-----------------------------------------------------------------------------
+// Shared helpers
+//-----------------------------------------------------------------------------
+// splitmix64, turns any seed, 0 included, into well mixed state words
+static uint64_t SplitMix(uint64_t& x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+//-----------------------------------------------------------------------------
+// CRandom Member Functions
+//-----------------------------------------------------------------------------
+CRandom::CRandom(uint64_t nSeed, uint32_t nStream)
+{
+	Seed(nSeed, nStream);
+}
+
+CRandom::~CRandom()
+{
+}
+
+void CRandom::Seed(uint64_t nSeed, uint32_t nStream)
+{
+	uint64_t x = nSeed;
+	uint64_t a = SplitMix(x), b = SplitMix(x);
+
+	m_nState[0] = (uint32_t)a;
+	m_nState[1] = (uint32_t)(a >> 32);
+	m_nState[2] = (uint32_t)b;
+	m_nState[3] = (uint32_t)(b >> 32);
+	if (!(m_nState[0] | m_nState[1] | m_nState[2] | m_nState[3]))
+		m_nState[0] = 1;
+
+	for (uint32_t n = 0; n < nStream; n++)
+		Jump();
+}
+
+void CRandom::GetState(uint32_t state[4]) const
+{
+	for (int i = 0; i < 4; i++)
+		state[i] = m_nState[i];
+}
+
+// An all zero state would give zeros for ever, it is refused
+bool CRandom::SetState(const uint32_t state[4])
+{
+	if (!(state[0] | state[1] | state[2] | state[3]))
+		return false;
+
+	for (int i = 0; i < 4; i++)
+		m_nState[i] = state[i];
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Jump ()
+// Desc : The polynomial jump of the xoshiro128 family, the same as 2^64
+//		calls to Next().
+//-----------------------------------------------------------------------------
+void CRandom::Jump()
+{
+	static const uint32_t JUMP[4] = { 0x8764000B, 0xF542D2D3, 0x6FA035C3, 0x77F2DB5B };
+
+	uint32_t s[4] = { 0, 0, 0, 0 };
+	for (int i = 0; i < 4; i++)
+		for (int b = 0; b < 32; b++)
+		{
+			if (JUMP[i] & (1u << b))
+			{
+				s[0] ^= m_nState[0];
+				s[1] ^= m_nState[1];
+				s[2] ^= m_nState[2];
+				s[3] ^= m_nState[3];
+			}
+			Next();
+		}
+
+	m_nState[0] = s[0];
+	m_nState[1] = s[1];
+	m_nState[2] = s[2];
+	m_nState[3] = s[3];
+}
+
+//-----------------------------------------------------------------------------
+// Name : Fill ()
+// Desc : Next() with the state kept in locals across the loop, where the
+//		compiler can hold it in registers instead of writing it back after
+//		every draw.
+//-----------------------------------------------------------------------------
+void CRandom::Fill(uint32_t* pOut, size_t count)
+{
+	uint32_t s0 = m_nState[0], s1 = m_nState[1], s2 = m_nState[2], s3 = m_nState[3];
+
+	for (size_t i = 0; i < count; i++)
+	{
+		pOut[i] = Rotate(s1 * 5, 7) * 9;
+		uint32_t t = s1 << 9;
+
+		s2 ^= s0;
+		s3 ^= s1;
+		s1 ^= s2;
+		s0 ^= s3;
+		s2 ^= t;
+		s3 = Rotate(s3, 11);
+	}
+
+	m_nState[0] = s0;
+	m_nState[1] = s1;
+	m_nState[2] = s2;
+	m_nState[3] = s3;
+}
+
+void CRandom::FillFloat(float* pOut, size_t count, float a, float b)
+{
+	uint32_t bits[64];
+	for (size_t base = 0; base < count; base += 64)
+	{
+		size_t n = count - base < 64 ? count - base : 64;
+		Fill(bits, n);
+		for (size_t i = 0; i < n; i++)
+			pOut[base + i] = a + (b - a) * ((float)(bits[i] >> 8) * (1.0f / 16777216.0f));
+	}
+}
@@ -0,0 +1,550 @@
+//-----------------------------------------------------------------------------
+// File: Replay.cpp
+//
+// Desc: Writing and reading step input logs, seeking in them and playing
+//	   them back.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CReplay Specific Includes
+//-----------------------------------------------------------------------------
+#include "Replay.h"
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+const size_t	KEYFRAME_HEADER_SIZE	= 1 + sizeof(uint32_t) + sizeof(uint64_t);
+
+static bool StepBefore(const SReplayKeyframe& a, const SReplayKeyframe& b)
+{
+	return a.nStep < b.nStep;
+}
+
+//-----------------------------------------------------------------------------
+// CReplayWriter Member Functions
+//-----------------------------------------------------------------------------
+CReplayWriter::CReplayWriter()
+{
+	m_pFile				= NULL;
+	m_nOffset			= 0;
+	m_nHashInterval		= REPLAY_HASH_INTERVAL;
+	m_nKeyframeInterval	= 1;
+	m_nSteps			= 0;
+	m_nRolling			= 0;
+	m_iWidth			= 0;
+	m_iHeight			= 0;
+}
+
+CReplayWriter::~CReplayWriter()
+{
+	Close();
+}
+
+bool CReplayWriter::Open(const char* szFileName, const CGameWorld& world, uint32_t nHashInterval, uint32_t nKeyframeInterval)
+{
+	Close();
+
+	m_pFile = fopen(szFileName, "wb");
+	if (!m_pFile)
+		return false;
+
+	SReplayHeader header;
+	memset(&header, 0, sizeof(header));
+	header.nMagic				= REPLAY_MAGIC;
+	header.nVersion				= REPLAY_VERSION;
+	header.nHashInterval		= nHashInterval ? nHashInterval : 1;
+	header.nKeyframeInterval	= nKeyframeInterval ? nKeyframeInterval : 1;
+	header.nSeed				= world.GetSeed();
+
+	if (fwrite(&header, sizeof(header), 1, m_pFile) != 1)
+	{
+		fclose(m_pFile);
+		m_pFile = NULL;
+		return false;
+	}
+
+	m_nOffset			= sizeof(header);
+	m_nHashInterval		= header.nHashInterval;
+	m_nKeyframeInterval	= header.nKeyframeInterval;
+	m_nSteps			= 0;
+	m_nRolling			= 0;
+	m_iWidth			= 0;
+	m_iHeight			= 0;
+	m_Index.clear();
+
+	WriteKeyframe(world);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+// Desc : Ends the records with the keyframe index and the trailer pointing
+//		at it.
+//-----------------------------------------------------------------------------
+void CReplayWriter::Close()
+{
+	if (m_pFile == NULL)
+		return;
+
+	SReplayTrailer trailer;
+	memset(&trailer, 0, sizeof(trailer));
+	trailer.nIndexOffset	= m_nOffset;
+	trailer.nKeyframes		= (uint32_t)m_Index.size();
+	trailer.nSteps			= (uint32_t)m_nSteps;
+	trailer.nMagic			= REPLAY_INDEX_MAGIC;
+
+	if (!m_Index.empty())
+		WriteBytes(&m_Index[0], m_Index.size() * sizeof(SReplayKeyframe));
+	WriteBytes(&trailer, sizeof(trailer));
+
+	fclose(m_pFile);
+	m_pFile = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Write ()
+// Desc : Appends the record of the step just taken, and a keyframe after
+//		it every keyframe interval. The file's own buffer gathers the
+//		records, so a step does not reach the disk on its own.
+//-----------------------------------------------------------------------------
+void CReplayWriter::Write(const SGameInput& input, const CGameWorld& world)
+{
+	if (!m_pFile)
+		return;
+
+	uint8_t record[1 + 5 + 4 + 8];
+	size_t n = 1;
+
+	record[0] = (uint8_t)(input.nDirection & REPLAY_DIRECTION_MASK);
+
+	if (input.nFire > 0)
+	{
+		record[0] |= REPLAY_HAS_FIRE;
+		for (uint32_t nFire = (uint32_t)input.nFire; ; nFire >>= 7)
+		{
+			record[n++] = (uint8_t)((nFire & 0x7F) | (nFire > 0x7F ? 0x80 : 0));
+			if (nFire <= 0x7F)
+				break;
+		}
+	}
+
+	if (input.iWidth != m_iWidth || input.iHeight != m_iHeight)
+	{
+		record[0] |= REPLAY_HAS_FIELD;
+		uint16_t size[2] = { (uint16_t)input.iWidth, (uint16_t)input.iHeight };
+		memcpy(&record[n], size, sizeof(size));
+		n += sizeof(size);
+		m_iWidth	= input.iWidth;
+		m_iHeight	= input.iHeight;
+	}
+
+	if (++m_nSteps % m_nHashInterval == 0)
+	{
+		record[0] |= REPLAY_HAS_HASH;
+		m_nRolling = RollStateHash(m_nRolling, world.GetStateHash());
+		memcpy(&record[n], &m_nRolling, sizeof(m_nRolling));
+		n += sizeof(m_nRolling);
+	}
+
+	WriteBytes(record, n);
+
+	if (m_nSteps % m_nKeyframeInterval == 0)
+		WriteKeyframe(world);
+}
+
+void CReplayWriter::WriteBytes(const void* pData, size_t nBytes)
+{
+	fwrite(pData, 1, nBytes, m_pFile);
+	m_nOffset += nBytes;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteKeyframe () (Private)
+// Desc : A reader starting here has not seen the play field, so the next
+//		record carries it again.
+//-----------------------------------------------------------------------------
+void CReplayWriter::WriteKeyframe(const CGameWorld& world)
+{
+	world.SaveState(m_State);
+
+	SReplayKeyframe keyframe;
+	keyframe.nStep		= (uint32_t)m_nSteps;
+	keyframe.nReserved	= 0;
+	keyframe.nOffset	= m_nOffset;
+	m_Index.push_back(keyframe);
+
+	uint8_t nFlags = REPLAY_KEYFRAME;
+	uint32_t nBytes = (uint32_t)m_State.size();
+	WriteBytes(&nFlags, sizeof(nFlags));
+	WriteBytes(&nBytes, sizeof(nBytes));
+	WriteBytes(&m_nRolling, sizeof(m_nRolling));
+	if (nBytes)
+		WriteBytes(&m_State[0], nBytes);
+
+	m_iWidth	= -1;
+	m_iHeight	= -1;
+}
+
+//-----------------------------------------------------------------------------
+// CReplayReader Member Functions
+//-----------------------------------------------------------------------------
+CReplayReader::CReplayReader()
+{
+	memset(&m_Header, 0, sizeof(m_Header));
+	m_nEnd		= 0;
+	m_nSteps	= 0;
+	Rewind();
+}
+
+CReplayReader::~CReplayReader()
+{
+	Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open ()
+// Desc : Maps the file and finds its keyframes, from the index when the
+//		file was closed properly, else by walking the records up to the
+//		last whole one.
+//-----------------------------------------------------------------------------
+bool CReplayReader::Open(const char* szFileName)
+{
+	Close();
+
+	if (!m_File.Open(szFileName) || m_File.Size() < sizeof(m_Header))
+	{
+		Close();
+		return false;
+	}
+
+	memcpy(&m_Header, m_File.Data(), sizeof(m_Header));
+	if (m_Header.nMagic != REPLAY_MAGIC || m_Header.nVersion != REPLAY_VERSION
+		|| !m_Header.nHashInterval || !m_Header.nKeyframeInterval || !(ReadIndex() || ScanIndex()))
+	{
+		Close();
+		return false;
+	}
+
+	Rewind();
+	return true;
+}
+
+void CReplayReader::Close()
+{
+	m_File.Close();
+	m_Keyframes.clear();
+	memset(&m_Header, 0, sizeof(m_Header));
+	m_nEnd		= 0;
+	m_nSteps	= 0;
+	Rewind();
+}
+
+void CReplayReader::Rewind()
+{
+	m_nOffset	= sizeof(SReplayHeader);
+	m_nRolling	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadIndex () (Private)
+// Desc : Takes the index only when the trailer, the index and every
+//		keyframe it points at agree.
+//-----------------------------------------------------------------------------
+bool CReplayReader::ReadIndex()
+{
+	const uint8_t* pData = m_File.Data();
+	size_t nSize = m_File.Size();
+	if (nSize < sizeof(SReplayHeader) + sizeof(SReplayTrailer))
+		return false;
+
+	SReplayTrailer trailer;
+	memcpy(&trailer, pData + nSize - sizeof(trailer), sizeof(trailer));
+
+	size_t nIndexBytes = (size_t)trailer.nKeyframes * sizeof(SReplayKeyframe);
+	if (trailer.nMagic != REPLAY_INDEX_MAGIC || trailer.nKeyframes == 0 || trailer.nIndexOffset < sizeof(SReplayHeader)
+		|| nSize - sizeof(trailer) - sizeof(SReplayHeader) < nIndexBytes
+		|| trailer.nIndexOffset != nSize - sizeof(trailer) - nIndexBytes)
+		return false;
+
+	m_nEnd = (size_t)trailer.nIndexOffset;
+	m_Keyframes.resize(trailer.nKeyframes);
+	memcpy(&m_Keyframes[0], pData + m_nEnd, nIndexBytes);
+
+	for (size_t i = 0; i < m_Keyframes.size(); i++)
+	{
+		const SReplayKeyframe& keyframe = m_Keyframes[i];
+		if (keyframe.nOffset < sizeof(SReplayHeader) || keyframe.nOffset >= m_nEnd
+			|| pData[keyframe.nOffset] != REPLAY_KEYFRAME || keyframe.nStep > trailer.nSteps
+			|| (i > 0 && keyframe.nStep <= m_Keyframes[i - 1].nStep))
+		{
+			m_Keyframes.clear();
+			return false;
+		}
+	}
+
+	m_nSteps = trailer.nSteps;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ScanIndex () (Private)
+// Desc : For a file the game did not get to close. Whatever follows the
+//		last whole record or keyframe is left out.
+//-----------------------------------------------------------------------------
+bool CReplayReader::ScanIndex()
+{
+	const uint8_t* pData = m_File.Data();
+	m_Keyframes.clear();
+	m_nEnd		= m_File.Size();
+	m_nSteps	= 0;
+	Rewind();
+
+	size_t nValidEnd = m_nOffset;
+	for (;;)
+	{
+		if (m_nOffset < m_nEnd && pData[m_nOffset] == REPLAY_KEYFRAME)
+		{
+			uint32_t nBytes;
+			if (m_nEnd - m_nOffset < KEYFRAME_HEADER_SIZE)
+				break;
+			memcpy(&nBytes, pData + m_nOffset + 1, sizeof(nBytes));
+			if (m_nEnd - m_nOffset - KEYFRAME_HEADER_SIZE < nBytes)
+				break;
+
+			SReplayKeyframe keyframe;
+			keyframe.nStep		= (uint32_t)m_nSteps;
+			keyframe.nReserved	= 0;
+			keyframe.nOffset	= m_nOffset;
+			m_Keyframes.push_back(keyframe);
+
+			m_nOffset += KEYFRAME_HEADER_SIZE + nBytes;
+		}
+		else
+		{
+			SGameInput input;
+			bool bHash;
+			uint64_t nHash;
+			if (!Read(input, bHash, nHash))
+				break;
+			m_nSteps++;
+		}
+		nValidEnd = m_nOffset;
+	}
+
+	m_nEnd = nValidEnd;
+	return !m_Keyframes.empty();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Read ()
+// Desc : Keyframes on the way are stepped over whole.
+//-----------------------------------------------------------------------------
+bool CReplayReader::Read(SGameInput& input, bool& bHash, uint64_t& nHash)
+{
+	uint8_t nFlags;
+	for (;;)
+	{
+		if (!ReadBytes(&nFlags, 1))
+			return false;
+		if (nFlags != REPLAY_KEYFRAME)
+			break;
+
+		uint32_t nBytes;
+		if (!ReadBytes(&nBytes, sizeof(nBytes)) || m_nEnd - m_nOffset < sizeof(uint64_t) + (size_t)nBytes)
+			return false;
+		m_nOffset += sizeof(uint64_t) + nBytes;
+	}
+
+	input.nDirection	= nFlags & REPLAY_DIRECTION_MASK;
+	input.nFire			= 0;
+
+	if (nFlags & REPLAY_HAS_FIRE)
+	{
+		uint32_t nFire = 0;
+		for (int shift = 0; ; shift += 7)
+		{
+			uint8_t b;
+			if (shift > 28 || !ReadBytes(&b, 1))
+				return false;
+			nFire |= (uint32_t)(b & 0x7F) << shift;
+			if (!(b & 0x80))
+				break;
+		}
+		input.nFire = (int)nFire;
+	}
+
+	if (nFlags & REPLAY_HAS_FIELD)
+	{
+		uint16_t size[2];
+		if (!ReadBytes(size, sizeof(size)))
+			return false;
+		m_iWidth	= size[0];
+		m_iHeight	= size[1];
+	}
+	input.iWidth	= m_iWidth;
+	input.iHeight	= m_iHeight;
+
+	bHash = (nFlags & REPLAY_HAS_HASH) != 0;
+	return !bHash || ReadBytes(&nHash, sizeof(nHash));
+}
+
+bool CReplayReader::ReadBytes(void* pData, size_t nBytes)
+{
+	if (m_nEnd - m_nOffset < nBytes)
+		return false;
+
+	memcpy(pData, m_File.Data() + m_nOffset, nBytes);
+	m_nOffset += nBytes;
+	return true;
+}
+
+bool CReplayReader::Step(CGameWorld& world, bool& bMatch)
+{
+	SGameInput input;
+	bool bHash;
+	uint64_t nHash;
+
+	bMatch = true;
+	if (!Read(input, bHash, nHash))
+		return false;
+
+	world.Step(input);
+	if (bHash)
+	{
+		m_nRolling = RollStateHash(m_nRolling, world.GetStateHash());
+		bMatch = m_nRolling == nHash;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Seek ()
+// Desc : At most one keyframe interval of steps is simulated, each one
+//		checked like Play() does.
+//-----------------------------------------------------------------------------
+bool CReplayReader::Seek(CGameWorld& world, unsigned long nStep)
+{
+	if (m_Keyframes.empty() || nStep > m_nSteps)
+		return false;
+
+	// Last keyframe at or before the step
+	SReplayKeyframe target;
+	target.nStep = (uint32_t)nStep;
+	std::vector<SReplayKeyframe>::const_iterator it = std::upper_bound(m_Keyframes.begin(), m_Keyframes.end(), target, StepBefore);
+	if (it == m_Keyframes.begin())
+		return false;
+	const SReplayKeyframe& keyframe = *(it - 1);
+
+	uint32_t nBytes;
+	uint64_t nRolling;
+	m_nOffset = (size_t)keyframe.nOffset + 1;
+	if (!ReadBytes(&nBytes, sizeof(nBytes)) || !ReadBytes(&nRolling, sizeof(nRolling))
+		|| m_nEnd - m_nOffset < nBytes || !world.LoadState(m_File.Data() + m_nOffset, nBytes))
+	{
+		Rewind();
+		return false;
+	}
+
+	m_nOffset	+= nBytes;
+	m_nRolling	= nRolling;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+
+	for (unsigned long n = keyframe.nStep; n < nStep; n++)
+	{
+		bool bMatch;
+		if (!Step(world, bMatch) || !bMatch)
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Play ()
+// Desc : Starts a world from the log's seed and steps it with each record,
+//		rolling its state hash wherever the log holds one and comparing
+//		the two. The world loads its images like the game does.
+//-----------------------------------------------------------------------------
+bool CReplayReader::Play(SReplayResult& result)
+{
+	memset(&result, 0, sizeof(result));
+	if (m_Header.nMagic != REPLAY_MAGIC)
+		return false;
+
+	CGameWorld world;
+	if (!world.Init(m_Header.nSeed))
+		return false;
+
+	Rewind();
+
+	SGameInput input;
+	bool bHash;
+	uint64_t nHash = 0, nRolling = 0;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	while (Read(input, bHash, nHash))
+	{
+		world.Step(input);
+		result.nSteps++;
+
+		if (bHash)
+		{
+			nRolling = RollStateHash(nRolling, world.GetStateHash());
+			result.nHashes++;
+			if (nRolling != nHash)
+			{
+				result.nDivergedStep = result.nSteps;
+				break;
+			}
+			result.nLastMatchStep = result.nSteps;
+		}
+	}
+	result.fSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	result.iScore		= world.GetScore();
+	result.bGameOver	= world.IsGameOver();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MeasureSeek ()
+// Desc : The targets sit in the middle of nSeeks equal stretches of the
+//		log, so they land anywhere between two keyframes. Loading the
+//		world's images is left out.
+//-----------------------------------------------------------------------------
+bool CReplayReader::MeasureSeek(int nSeeks, double& msMean, double& msMax)
+{
+	msMean = msMax = 0.0;
+	if (nSeeks <= 0 || m_Keyframes.empty())
+		return false;
+
+	CGameWorld world;
+	if (!world.Init(m_Header.nSeed))
+		return false;
+
+	double msTotal = 0.0;
+	for (int i = 0; i < nSeeks; i++)
+	{
+		unsigned long nStep = (unsigned long)(((uint64_t)m_nSteps * (2 * i + 1)) / (2 * (uint64_t)nSeeks));
+
+		std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+		bool bSeek = Seek(world, nStep);
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+		if (!bSeek)
+			return false;
+
+		msTotal += ms;
+		if (ms > msMax)
+			msMax = ms;
+	}
+
+	msMean = msTotal / nSeeks;
+	Rewind();
+	return true;
+}
@@ -1,5 +1,14 @@
 #include "ResizeEngine.h"
 
+// Rounds a filtered channel value and clamps it to a byte. Filters with
+// negative lobes (bicubic, Lanczos) can overshoot either end.
+static inline BYTE ClampToByte(double dVal)
+{
+	if (dVal <= 0.0) return 0;
+	if (dVal >= 255.0) return 255;
+	return (BYTE)(dVal + 0.5);
+}
+
 CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrcSize) 
 {
 	DWORD u;
@@ -37,7 +46,7 @@ CWeightsTable::CWeightsTable(CGenericFilter *pFilter, DWORD uDstSize, DWORD uSrc
 	for(u = 0; u < m_LineLength; u++) 
 	{
 		// scan through line of contributions
-		double dCenter = (double)u / dScale;   // reverse mapping
+		double dCenter = ((double)u + 0.5) / dScale - 0.5;   // reverse mapping (pixel centers)
 		// find the significant edge points that affect the pixel
 		int iLeft = max(0, (int)floor(dCenter - dWidth));
 		int iRight = min((int)ceil(dCenter + dWidth), int(uSrcSize) - 1);
@@ -101,24 +110,27 @@ void CResizableImage::ScaleRow(unsigned int dst_width, unsigned int /*dst_height
 	for (UINT x = 0; x < dst_width; x++) 
 	{
 		// Loop through row
-		BYTE r = 0;
-		BYTE g = 0;
-		BYTE b = 0;
+		double r = 0;
+		double g = 0;
+		double b = 0;
+		double a = 0;
 		int iLeft = m_pWeights->getLeftBoundary(x);	// Retrieve left boundries
 		int iRight = m_pWeights->getRightBoundary(x);  // Retrieve right boundries
 		for (int i = iLeft; i <= iRight; i++)
 		{
 			// Scan between boundries
 			// Accumulate weighted effect of each neighboring pixel
-			r += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbRed)); 
-			g += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbGreen)); 
-			b += (BYTE)(m_pWeights->getWeight(x, i-iLeft) * (double)(pSrcRow[i].rgbBlue)); 
+			double weight = m_pWeights->getWeight(x, i-iLeft);
+			r += weight * (double)(pSrcRow[i].rgbRed); 
+			g += weight * (double)(pSrcRow[i].rgbGreen); 
+			b += weight * (double)(pSrcRow[i].rgbBlue); 
+			a += weight * (double)(pSrcRow[i].rgbReserved); 
 		} 
 		// set destination row
-		pDstRow[x].rgbRed = r;
-		pDstRow[x].rgbGreen = g;
-		pDstRow[x].rgbBlue = b;
-		pDstRow[x].rgbReserved = 0;
+		pDstRow[x].rgbRed = ClampToByte(r);
+		pDstRow[x].rgbGreen = ClampToByte(g);
+		pDstRow[x].rgbBlue = ClampToByte(b);
+		pDstRow[x].rgbReserved = ClampToByte(a);
 	}
 }
 
@@ -129,6 +141,7 @@ void CResizableImage::HorizontalFilter(unsigned int dst_width, unsigned int dst_
 	{
 		// No scaling required, just copy
 		memcpy (m_pResImg, m_pRGB, sizeof(RGBQUAD) * width * height);
+		return;
 	}
 	
 	m_pWeights = new CWeightsTable(m_pFilter, dst_width, width);
@@ -147,9 +160,10 @@ void CResizableImage::ScaleCol(unsigned int dst_width, unsigned int dst_height,
 	for (UINT y = 0; y < dst_height; y++) 
 	{
 		// Loop through column
-		BYTE r = 0;
-		BYTE g = 0;
-		BYTE b = 0;
+		double r = 0;
+		double g = 0;
+		double b = 0;
+		double a = 0;
 		int iLeft = m_pWeights->getLeftBoundary(y);	// Retrieve left boundries
 		int iRight = m_pWeights->getRightBoundary(y);  // Retrieve right boundries
 		for (int i = iLeft; i <= iRight; i++)
@@ -157,16 +171,18 @@ void CResizableImage::ScaleCol(unsigned int dst_width, unsigned int dst_height,
 			// Scan between boundries
 			// Accumulate weighted effect of each neighboring pixel
 			RGBQUAD &src = m_pRGB[i * width + col];
-			r += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbRed));
-			g += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbGreen));
-			b += (BYTE)(m_pWeights->getWeight(y, i-iLeft) * (double)(src.rgbBlue));
+			double weight = m_pWeights->getWeight(y, i-iLeft);
+			r += weight * (double)(src.rgbRed);
+			g += weight * (double)(src.rgbGreen);
+			b += weight * (double)(src.rgbBlue);
+			a += weight * (double)(src.rgbReserved);
 		}
 
 		RGBQUAD &dst = m_pResImg[y * dst_width + col];
-		dst.rgbRed = r;
-		dst.rgbGreen = g;
-		dst.rgbBlue = b;
-		dst.rgbReserved = 0;
+		dst.rgbRed = ClampToByte(r);
+		dst.rgbGreen = ClampToByte(g);
+		dst.rgbBlue = ClampToByte(b);
+		dst.rgbReserved = ClampToByte(a);
 	}
 }
 
@@ -177,6 +193,7 @@ void CResizableImage::VerticalFilter(unsigned int dst_width, unsigned int dst_he
 	{
 		// No scaling required, just copy
 		memcpy(m_pResImg, m_pRGB, sizeof (RGBQUAD) * width * height);
+		return;
 	}
 	
 	m_pWeights = new CWeightsTable(m_pFilter, dst_height, height);
@@ -199,7 +216,7 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 
 		HorizontalFilter(dst_width, height);
 		
-		delete m_pRGB;
+		delete[] m_pRGB;
 		m_pRGB = m_pResImg;
 		width = dst_width;
 		m_pResImg = new RGBQUAD[dst_width * dst_height];
@@ -211,7 +228,7 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 		m_pResImg = new RGBQUAD[width * dst_height];
 		VerticalFilter(width, dst_height);
 		
-		delete m_pRGB;
+		delete[] m_pRGB;
 		m_pRGB = m_pResImg;
 		height = dst_height;
 		m_pResImg = new RGBQUAD[dst_width * dst_height];
@@ -219,11 +236,53 @@ void CResizableImage::Resample(unsigned dst_width, unsigned dst_height)
 		HorizontalFilter(dst_width, dst_height);
 	}
 
-	delete m_pRGB;
+	delete[] m_pRGB;
 	m_pRGB = m_pResImg;
 	width = dst_width;
 	height = dst_height;
 
 	DeleteObject(m_hBMP);
 	m_hBMP = 0;
-}
\ No newline at end of file
+}
+bool CResizableImage::LoadFromFrameBuffer(const CFrameBuffer& src)
+{
+	if(!src.IsValid())
+		return false;
+
+	if(m_pRGB)
+		delete[] m_pRGB;
+
+	if(m_hBMP)
+	{
+		DeleteObject(m_hBMP);
+		m_hBMP = 0;
+	}
+
+	ZeroMemory(&m_biInfo, sizeof(BITMAPINFOHEADER));
+	m_biInfo.biSize = sizeof(BITMAPINFOHEADER);
+	m_biInfo.biWidth = src.Width();
+	m_biInfo.biHeight = src.Height();
+	m_biInfo.biPlanes = 1;
+	m_biInfo.biBitCount = 32;
+	m_biInfo.biCompression = BI_RGB;
+
+	m_pRGB = new RGBQUAD[width * height];
+
+	// RGBQUAD has the framebuffer byte order, rows are stored bottom-up
+	// like the ones LoadBitmapFromFile reads
+	for(int y = 0; y < height; y++)
+		memcpy(&m_pRGB[(height - 1 - y) * width], src.Row(y), sizeof(RGBQUAD) * width);
+
+	return true;
+}
+
+bool CResizableImage::CopyToFrameBuffer(CFrameBuffer& dst) const
+{
+	if(!m_pRGB || !dst.Create(width, height))
+		return false;
+
+	for(int y = 0; y < height; y++)
+		memcpy(dst.Row(y), &m_pRGB[(height - 1 - y) * width], sizeof(RGBQUAD) * width);
+
+	return true;
+}
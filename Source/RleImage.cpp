@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// File: RleImage.cpp
+//
+// Desc: Run-length encoded opaque spans of a masked image.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRleImage Specific Includes
+//-----------------------------------------------------------------------------
+#include "RleImage.h"
+
+//-----------------------------------------------------------------------------
+// CRleImage Member Functions
+//-----------------------------------------------------------------------------
+CRleImage::CRleImage()
+{
+	m_nOpaque	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+}
+
+CRleImage::~CRleImage()
+{
+	Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Scans every row once and records the runs of pixels with a non
+//		zero alpha.
+//-----------------------------------------------------------------------------
+bool CRleImage::Build(const CFrameBuffer& image)
+{
+	Release();
+
+	if (!image.IsValid() || image.Width() > 0xFFFF)
+		return false;
+
+	m_iWidth	= image.Width();
+	m_iHeight	= image.Height();
+	m_RowStart.reserve(m_iHeight + 1);
+
+	for (int y = 0; y < m_iHeight; y++)
+	{
+		const uint32_t* pRow = image.Row(y);
+		m_RowStart.push_back((uint32_t)m_Spans.size());
+
+		int x = 0;
+		while (x < m_iWidth)
+		{
+			// Skip the transparent run
+			while (x < m_iWidth && (pRow[x] >> 24) == 0) x++;
+			if (x == m_iWidth) break;
+
+			int start = x;
+			while (x < m_iWidth && (pRow[x] >> 24) != 0) x++;
+
+			SRleSpan span = { (uint16_t)start, (uint16_t)(x - start) };
+			m_Spans.push_back(span);
+			m_nOpaque += x - start;
+		}
+	}
+
+	m_RowStart.push_back((uint32_t)m_Spans.size());
+	return true;
+}
+
+void CRleImage::Release()
+{
+	m_Spans.clear();
+	m_RowStart.clear();
+	m_nOpaque	= 0;
+	m_iWidth	= 0;
+	m_iHeight	= 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetOpaqueRatio ()
+// Desc : Fraction of the image the spans cover, 1.0 for a solid rectangle.
+//-----------------------------------------------------------------------------
+float CRleImage::GetOpaqueRatio() const
+{
+	size_t total = (size_t)m_iWidth * m_iHeight;
+	return total ? (float)m_nOpaque / (float)total : 0.0f;
+}
@@ -0,0 +1,86 @@
+//-----------------------------------------------------------------------------
+// File: ScrollingBackground.cpp
+//
+// Desc: Vertically scrolling, wrapping background.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CScrollingBackground Specific Includes
+//-----------------------------------------------------------------------------
+#include "ScrollingBackground.h"
+#include "Blitter.h"
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// CScrollingBackground Member Functions
+//-----------------------------------------------------------------------------
+CScrollingBackground::CScrollingBackground()
+{
+	m_pImage		= NULL;
+	m_fOffset		= 0.0f;
+	m_fSpeed		= BACKGROUND_SCROLL_SPEED;
+	m_bScrolling	= true;
+}
+
+CScrollingBackground::~CScrollingBackground()
+{
+}
+
+void CScrollingBackground::SetImage(const CFrameBuffer* pImage)
+{
+	m_pImage	= pImage;
+	m_fOffset	= 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Update ()
+// Desc : Moves the background by speed * elapsed seconds, wrapping at the
+//		image height.
+//-----------------------------------------------------------------------------
+void CScrollingBackground::Update(float fTimeElapsed)
+{
+	if (!m_bScrolling || !m_pImage || m_pImage->Height() <= 0)
+		return;
+
+	float fHeight = (float)m_pImage->Height();
+	m_fOffset = fmodf(m_fOffset + m_fSpeed * fTimeElapsed, fHeight);
+	if (m_fOffset < 0.0f)
+		m_fOffset += fHeight;
+
+	// fmodf can round up to exactly the height
+	if (m_fOffset >= fHeight)
+		m_fOffset = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Draw ()
+// Desc : Copies the visible window of the image into target, a view of the
+//		screen whose top-left is (originX, originY). Rows run from the scroll
+//		row down to the end of the image, then on from its first row, so the
+//		copy is at most two spans and never touches rows that are not seen.
+//-----------------------------------------------------------------------------
+void CScrollingBackground::Draw(CFrameBuffer& target, int originX, int originY) const
+{
+	if (!m_pImage || !m_pImage->IsValid())
+		return;
+
+	const CFrameBuffer& image = *m_pImage;
+	int imageH = image.Height();
+
+	// Columns the image does not reach stay white
+	if (originX < 0 || image.Width() - originX < target.Width())
+		target.Clear(0x00FFFFFF);
+
+	int y = 0;
+	while (y < target.Height())
+	{
+		int row = (GetRow() + originY + y) % imageH;
+		int h = imageH - row;
+		if (h > target.Height() - y)
+			h = target.Height() - y;
+
+		CBlitter::Blit(target, -originX, y, image, 0, row, image.Width(), h, BLIT_OPAQUE);
+		y += h;
+	}
+}
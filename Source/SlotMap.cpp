@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// File: SlotMap.cpp
+//
+// Desc: Generational handles onto densely packed elements.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSlotMap Specific Includes
+//-----------------------------------------------------------------------------
+#include "SlotMap.h"
+#include <assert.h>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const uint32_t FREE_NONE = 0xFFFFFFFF;
+
+//-----------------------------------------------------------------------------
+// CSlotMap Member Functions
+//-----------------------------------------------------------------------------
+CSlotMap::CSlotMap()
+{
+	m_nFreeHead = FREE_NONE;
+}
+
+CSlotMap::~CSlotMap()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Insert ()
+// Desc : Reuses the most recently freed slot, or adds one.
+//-----------------------------------------------------------------------------
+SSlotHandle CSlotMap::Insert()
+{
+	uint32_t nSlot = m_nFreeHead;
+	if (nSlot != FREE_NONE)
+		m_nFreeHead = m_Slots[nSlot].nIndex;
+	else
+	{
+		SSlot slot = { 0, 0 };
+		nSlot = (uint32_t)m_Slots.size();
+		m_Slots.push_back(slot);
+	}
+
+	SSlot& slot = m_Slots[nSlot];
+	slot.nIndex = (uint32_t)m_DenseSlot.size();
+	slot.nGeneration++;
+	m_DenseSlot.push_back(nSlot);
+
+	SSlotHandle handle = { nSlot, slot.nGeneration };
+	return handle;
+}
+
+size_t CSlotMap::Remove(SSlotHandle handle)
+{
+	size_t index = Find(handle);
+	if (index == SLOT_NONE)
+		return SLOT_NONE;
+
+	return RemoveAt(index);
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemoveAt ()
+// Desc : Frees the slot of the element at index and points the slot of the
+//		last element at index, where the owner is about to move it.
+//-----------------------------------------------------------------------------
+size_t CSlotMap::RemoveAt(size_t index)
+{
+	assert(index < m_DenseSlot.size());
+
+	uint32_t nSlot = m_DenseSlot[index];
+	uint32_t nLastSlot = m_DenseSlot.back();
+
+	m_Slots[nLastSlot].nIndex = (uint32_t)index;
+	m_DenseSlot[index] = nLastSlot;
+	m_DenseSlot.pop_back();
+
+	SSlot& slot = m_Slots[nSlot];
+	slot.nGeneration++;
+	slot.nIndex = m_nFreeHead;
+	m_nFreeHead = nSlot;
+
+	return index;
+}
+
+size_t CSlotMap::Find(SSlotHandle handle) const
+{
+	if (handle.nSlot >= m_Slots.size())
+		return SLOT_NONE;
+
+	const SSlot& slot = m_Slots[handle.nSlot];
+	if (slot.nGeneration != handle.nGeneration || !(slot.nGeneration & 1))
+		return SLOT_NONE;
+
+	return slot.nIndex;
+}
+
+SSlotHandle CSlotMap::GetHandle(size_t index) const
+{
+	uint32_t nSlot = m_DenseSlot[index];
+	SSlotHandle handle = { nSlot, m_Slots[nSlot].nGeneration };
+	return handle;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Frees every live slot. The slots are kept, with their generations
+//		bumped, so handles from before the clear stay stale.
+//-----------------------------------------------------------------------------
+void CSlotMap::Clear()
+{
+	while (!m_DenseSlot.empty())
+		RemoveAt(m_DenseSlot.size() - 1);
+}
+
+void CSlotMap::Reserve(size_t count)
+{
+	m_Slots.reserve(count);
+	m_DenseSlot.reserve(count);
+}
@@ -0,0 +1,212 @@
+//-----------------------------------------------------------------------------
+// File: SpatialGrid.cpp
+//
+// Desc: Hashed uniform grid broadphase.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Specific Includes
+//-----------------------------------------------------------------------------
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+static const uint32_t	MIN_BUCKETS	= 64;
+static const float		CELL_LIMIT	= 1048576.0f;	// Cell coordinates are clamped to this
+
+//-----------------------------------------------------------------------------
+// CSpatialGrid Member Functions
+//-----------------------------------------------------------------------------
+CSpatialGrid::CSpatialGrid(float fCellSize)
+{
+	m_fCellSize		= fCellSize;
+	m_fInvCellSize	= 1.0f / fCellSize;
+	m_nBucketMask	= MIN_BUCKETS - 1;
+	m_nQuery		= 0;
+	m_iMinCellX		= 0;
+	m_iMinCellY		= 0;
+	m_iMaxCellX		= -1;
+	m_iMaxCellY		= -1;
+
+	m_BucketStart.assign(MIN_BUCKETS + 1, 0);
+}
+
+CSpatialGrid::~CSpatialGrid()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Counting sort of the box and cell pairs by bucket: count the
+//		pairs of each bucket, turn the counts into bucket ends, then walk
+//		the boxes backwards writing each pair just below its bucket's end.
+//		That leaves every bucket's start in m_BucketStart and its boxes in
+//		ascending order. About two buckets a box keeps collisions rare.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Build(const SAabb* pBoxes, size_t count)
+{
+	m_Boxes.assign(pBoxes, pBoxes + count);
+
+	uint32_t nBuckets = MIN_BUCKETS;
+	while (nBuckets < count * 2)
+		nBuckets <<= 1;
+	m_nBucketMask = nBuckets - 1;
+	m_BucketStart.assign(nBuckets + 1, 0);
+
+	m_iMinCellX = m_iMinCellY = (int)CELL_LIMIT;
+	m_iMaxCellX = m_iMaxCellY = -(int)CELL_LIMIT;
+
+	int x0, y0, x1, y1;
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!GetCells(pBoxes[i], x0, y0, x1, y1))
+			continue;
+
+		m_iMinCellX = x0 < m_iMinCellX ? x0 : m_iMinCellX;
+		m_iMinCellY = y0 < m_iMinCellY ? y0 : m_iMinCellY;
+		m_iMaxCellX = x1 > m_iMaxCellX ? x1 : m_iMaxCellX;
+		m_iMaxCellY = y1 > m_iMaxCellY ? y1 : m_iMaxCellY;
+
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++)
+				m_BucketStart[GetBucket(x, y)]++;
+	}
+
+	for (uint32_t b = 1; b < nBuckets; b++)
+		m_BucketStart[b] += m_BucketStart[b - 1];
+	m_BucketStart[nBuckets] = m_BucketStart[nBuckets - 1];
+
+	m_Entries.resize(m_BucketStart[nBuckets]);
+	for (size_t i = count; i-- > 0; )
+	{
+		if (!GetCells(pBoxes[i], x0, y0, x1, y1))
+			continue;
+
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++)
+				m_Entries[--m_BucketStart[GetBucket(x, y)]] = (uint32_t)i;
+	}
+
+	m_Stamp.assign(count, 0);
+	m_nQuery = 0;
+
+	// No query can find more, so queries never allocate
+	m_Result.reserve(count);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reserve ()
+// Desc : Room for count boxes covering nCellsEach cells on average, so
+//		building up to that many does not allocate.
+//-----------------------------------------------------------------------------
+void CSpatialGrid::Reserve(size_t count, size_t nCellsEach)
+{
+	uint32_t nBuckets = MIN_BUCKETS;
+	while (nBuckets < count * 2)
+		nBuckets <<= 1;
+
+	m_Boxes.reserve(count);
+	m_BucketStart.reserve(nBuckets + 1);
+	m_Entries.reserve(count * nCellsEach);
+	m_Stamp.reserve(count);
+	m_Result.reserve(count);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Query ()
+// Desc : Within a bucket the boxes are in ascending order, so a box in one
+//		cell is answered straight from its bucket; the only repeats there
+//		are one box filed under two cells that hash alike, and they are
+//		next to each other. Over more cells a box turns up once per cell
+//		it shares with the query; the stamp skips it after the first
+//		time and the result is sorted at the end.
+//-----------------------------------------------------------------------------
+const std::vector<uint32_t>& CSpatialGrid::Query(const SAabb& box)
+{
+	m_Result.clear();
+	if (m_Boxes.empty())
+		return m_Result;
+
+	// Cells past the built boxes hold nothing
+	int x0, y0, x1, y1;
+	if (!GetCells(box, x0, y0, x1, y1))
+		return m_Result;
+
+	x0 = x0 < m_iMinCellX ? m_iMinCellX : x0;
+	y0 = y0 < m_iMinCellY ? m_iMinCellY : y0;
+	x1 = x1 > m_iMaxCellX ? m_iMaxCellX : x1;
+	y1 = y1 > m_iMaxCellY ? m_iMaxCellY : y1;
+	if (x0 > x1 || y0 > y1)
+		return m_Result;
+
+	if (x0 == x1 && y0 == y1)
+	{
+		uint32_t b = GetBucket(x0, y0);
+		for (uint32_t e = m_BucketStart[b]; e < m_BucketStart[b + 1]; e++)
+		{
+			uint32_t i = m_Entries[e];
+			if (Overlaps(box, m_Boxes[i]) && (m_Result.empty() || m_Result.back() != i))
+				m_Result.push_back(i);
+		}
+		return m_Result;
+	}
+
+	if (++m_nQuery == 0)
+	{
+		std::fill(m_Stamp.begin(), m_Stamp.end(), 0);
+		m_nQuery = 1;
+	}
+
+	for (int y = y0; y <= y1; y++)
+	{
+		for (int x = x0; x <= x1; x++)
+		{
+			uint32_t b = GetBucket(x, y);
+			for (uint32_t e = m_BucketStart[b]; e < m_BucketStart[b + 1]; e++)
+			{
+				uint32_t i = m_Entries[e];
+				if (m_Stamp[i] == m_nQuery)
+					continue;
+
+				m_Stamp[i] = m_nQuery;
+				if (Overlaps(box, m_Boxes[i]))
+					m_Result.push_back(i);
+			}
+		}
+	}
+
+	std::sort(m_Result.begin(), m_Result.end());
+	return m_Result;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetCells () (Private)
+// Desc : The inclusive range of cells under box. A box ending exactly on a
+//		cell edge also takes the next cell, where a box starting at that
+//		edge is filed, so touching boxes are found. Cell coordinates are
+//		clamped to CELL_LIMIT before they become ints; false for a box
+//		with an edge that is not finite, it is under no cell.
+//-----------------------------------------------------------------------------
+bool CSpatialGrid::GetCells(const SAabb& box, int& x0, int& y0, int& x1, int& y1) const
+{
+	if (!std::isfinite(box.fMinX) || !std::isfinite(box.fMinY) || !std::isfinite(box.fMaxX) || !std::isfinite(box.fMaxY))
+		return false;
+
+	float fMinX = floorf(box.fMinX * m_fInvCellSize), fMaxX = floorf(box.fMaxX * m_fInvCellSize);
+	float fMinY = floorf(box.fMinY * m_fInvCellSize), fMaxY = floorf(box.fMaxY * m_fInvCellSize);
+
+	x0 = (int)(fMinX < -CELL_LIMIT ? -CELL_LIMIT : fMinX > CELL_LIMIT ? CELL_LIMIT : fMinX);
+	x1 = (int)(fMaxX < -CELL_LIMIT ? -CELL_LIMIT : fMaxX > CELL_LIMIT ? CELL_LIMIT : fMaxX);
+	y0 = (int)(fMinY < -CELL_LIMIT ? -CELL_LIMIT : fMinY > CELL_LIMIT ? CELL_LIMIT : fMinY);
+	y1 = (int)(fMaxY < -CELL_LIMIT ? -CELL_LIMIT : fMaxY > CELL_LIMIT ? CELL_LIMIT : fMaxY);
+	return true;
+}
+
+uint32_t CSpatialGrid::GetBucket(int x, int y) const
+{
+	return (((uint32_t)x * 73856093u) ^ ((uint32_t)y * 19349663u)) & m_nBucketMask;
+}
@@ -1,69 +1,82 @@
 #include "Sprite.h"
+#include "BackBuffer.h"
+#include "Blitter.h"
 #include <cmath>
+#include <chrono>
 
-extern HINSTANCE g_hInst;
+uint32_t Sprite::msNextId = 1;
 
+#ifdef _WIN32
 Sprite::Sprite(int imageID, int maskID)
 {
-	// Load the bitmap resources.
-	mhImage = LoadBitmap(g_hInst, MAKEINTRESOURCE(imageID));
-	mhMask = LoadBitmap(g_hInst, MAKEINTRESOURCE(maskID));
+	// Get the bitmap resources from the asset cache.
+	mpImage = g_AssetCache.Acquire(imageID);
+	mpMask = g_AssetCache.Acquire(maskID);
 
 	mfScaleX = 1.0f;
 	mfScaleY = 1.0f;
-	// Get the BITMAP structure for each of the bitmaps.
-	GetObject(mhImage, sizeof(BITMAP), &mImageBM);
-	GetObject(mhMask, sizeof(BITMAP), &mMaskBM);
 
 	// Image and Mask should be the same dimensions.
-	assert(mImageBM.bmWidth == mMaskBM.bmWidth);
-	assert(mImageBM.bmHeight == mMaskBM.bmHeight);	
+	assert(mpImage && mpMask);
+	assert(mpImage->Width() == mpMask->Width());
+	assert(mpImage->Height() == mpMask->Height());
 
-	mcTransparentColor = 0;
-	mhSpriteDC = 0;
+	// Merge the mask into the image once, drawing is then a keyed copy.
+	if( mpImage ) mpImage->BuildMask(mpMask);
+
+	mnTransparentColor = 0;
+	mpBackBuffer = NULL;
+	mpScaled = NULL;
+	mId = msNextId++;
 }
+#endif
 
 Sprite::Sprite(const char *szImageFile, const char *szMaskFile)
 {
-	mhImage = (HBITMAP)LoadImage(g_hInst, szImageFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
-	mhMask = (HBITMAP)LoadImage(g_hInst, szMaskFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
+	// Decoded once by the asset cache, then shared.
+	mpImage = g_AssetCache.Acquire(szImageFile);
+	mpMask = g_AssetCache.Acquire(szMaskFile);
 
 	mfScaleX = 1.0f;
 	mfScaleY = 1.0f;
-	// Get the BITMAP structure for each of the bitmaps.
-	GetObject(mhImage, sizeof(BITMAP), &mImageBM);
-	GetObject(mhMask, sizeof(BITMAP), &mMaskBM);
 
 	// Image and Mask should be the same dimensions.
-	assert(mImageBM.bmWidth == mMaskBM.bmWidth);
-	assert(mImageBM.bmHeight == mMaskBM.bmHeight);
+	assert(mpImage && mpMask);
+	assert(mpImage->Width() == mpMask->Width());
+	assert(mpImage->Height() == mpMask->Height());
+
+	// Merge the mask into the image once, drawing is then a keyed copy.
+	if( mpImage ) mpImage->BuildMask(mpMask);
 
-	mcTransparentColor = 0;
-	mhSpriteDC = 0;
+	mnTransparentColor = 0;
+	mpBackBuffer = NULL;
+	mpScaled = NULL;
+	mId = msNextId++;
 }
 
-Sprite::Sprite(const char *szImageFile, COLORREF crTransparentColor)
+Sprite::Sprite(const char *szImageFile, uint32_t nTransparentColor)
 {
-	mhImage = (HBITMAP)LoadImage(g_hInst, szImageFile, IMAGE_BITMAP, 0, 0, LR_CREATEDIBSECTION | LR_LOADFROMFILE);
+	mpImage = g_AssetCache.Acquire(szImageFile);
+	mpMask = NULL;
+
+	// Build the transparency mask once per image, not once per draw.
+	if( mpImage ) mpImage->BuildColorKeyMask(nTransparentColor);
 
 	mfScaleX = 1.0f;
 	mfScaleY = 1.0f;
 
-	mhMask = 0;
-	mhSpriteDC = 0;
-	mcTransparentColor = crTransparentColor;
-
-	// Get the BITMAP structure for the bitmap.
-	GetObject(mhImage, sizeof(BITMAP), &mImageBM);
+	mnTransparentColor = nTransparentColor;
+	mpBackBuffer = NULL;
+	mpScaled = NULL;
+	mId = msNextId++;
 }
 
 Sprite::~Sprite()
 {
-	// Free the resources we created in the constructor.
-	DeleteObject(mhImage);
-	DeleteObject(mhMask);
-
-	DeleteDC(mhSpriteDC);
+	// Hand the shared images back to the cache.
+	g_AssetCache.Release(mpImage);
+	g_AssetCache.Release(mpMask);
+	g_AssetCache.Release(mpScaled);
 }
 
 void Sprite::update(float dt)
@@ -76,18 +89,22 @@ void Sprite::update(float dt)
 
 void Sprite::setBackBuffer(const BackBuffer *pBackBuffer)
 {
+	// The image DCs belong to the shared assets, nothing to create here.
 	mpBackBuffer = pBackBuffer;
-	if(mpBackBuffer)
-	{
-		DeleteDC(mhSpriteDC);
-		mhSpriteDC = CreateCompatibleDC(mpBackBuffer->getDC());
-	}
 }
 
 void Sprite::setScale(float scaleX, float scaleY)
 {
 	mfScaleX = scaleX;
 	mfScaleY = scaleY;
+
+	// Resample once through the asset cache (shared by every sprite using
+	// the same image and scale), drawing is then an unscaled blit.
+	g_AssetCache.Release(mpScaled);
+	mpScaled = NULL;
+
+	if( mpImage && (scaleX != 1.0f || scaleY != 1.0f) )
+		mpScaled = g_AssetCache.AcquireScaled(mpImage, scaleX, scaleY);
 }
 
 Vec2 Sprite::getScale()
@@ -95,9 +112,24 @@ Vec2 Sprite::getScale()
 	return Vec2(mfScaleX, mfScaleY);
 }
 
+SAtlasRect Sprite::drawnRect() const
+{
+	const CSpriteAsset* pDrawn = drawnImage();
+	int w = mpImage ? mpImage->Width() : 0;
+	int h = mpImage ? mpImage->Height() : 0;
+
+	// Same upper-left corner as draw()
+	SAtlasRect rc = { (int)mPosition.x - (w / 2), (int)mPosition.y - (h / 2),
+					  pDrawn ? pDrawn->Width() : 0, pDrawn ? pDrawn->Height() : 0 };
+	return rc;
+}
+
 void Sprite::draw()
 {
-	if( mhMask != 0 )
+	if( mpImage == NULL )
+		return;
+
+	if( mpMask != NULL )
 		drawMask();
 	else
 		drawTransparent();
@@ -108,8 +140,6 @@ void Sprite::drawMask()
 	if( mpBackBuffer == NULL )
 		return;
 
-	HDC hBackBufferDC = mpBackBuffer->getDC();
-
 	// The position BitBlt wants is not the sprite's center
 	// position; rather, it wants the upper-left position,
 	// so compute that.
@@ -120,28 +150,9 @@ void Sprite::drawMask()
 	int x = (int)mPosition.x - (fW / 2);
 	int y = (int)mPosition.y - (fH / 2);
 
-	// Note: For this masking technique to work, it is assumed
-	// the backbuffer bitmap has been cleared to some
-	// non-zero value.
-	// Select the mask bitmap.
-	HGDIOBJ oldObj = SelectObject(mhSpriteDC, mhMask);
-
-	// Draw the mask to the backbuffer with SRCAND. This
-	// only draws the black pixels in the mask to the backbuffer,
-	// thereby marking the pixels we want to draw the sprite
-	// image onto.
-	BitBlt(hBackBufferDC, x, y, fW, fH, mhSpriteDC, 0, 0, SRCAND);
-
-	// Now select the image bitmap.
-	SelectObject(mhSpriteDC, mhImage);
-
-	// Draw the image to the backbuffer with SRCPAINT. This
-	// will only draw the image onto the pixels that where previously
-	// marked black by the mask.
-	BitBlt(hBackBufferDC, x, y, fW, fH, mhSpriteDC, 0, 0, SRCPAINT);
-
-	// Restore the original bitmap object.
-	SelectObject(mhSpriteDC, oldObj);
+	// The mask was merged into the image when the sprite was created,
+	// only the opaque runs are copied.
+	CBlitter::BlitSpans(mpBackBuffer->getFrameBuffer(), x, y, mpImage->Image(), mpImage->Spans(), 0, 0, fW, fH);
 }
 
 void Sprite::drawTransparent()
@@ -149,70 +160,96 @@ void Sprite::drawTransparent()
 	if( mpBackBuffer == NULL )
 		return;
 
-	HDC hBackBuffer = mpBackBuffer->getDC();
-
 	int w = width();
 	int h = height();
 
-	float sx = mfScaleX;
-	float sy = mfScaleY;
-
 	// Upper-left corner.
 	int x = (int)mPosition.x - (w / 2);
 	int y = (int)mPosition.y - (h / 2);
 
-	COLORREF crOldBack = SetBkColor(hBackBuffer, RGB(255, 255, 255));
-	COLORREF crOldText = SetTextColor(hBackBuffer, RGB(0, 0, 0));
-	HDC dcImage, dcTrans;
-
-	// Create two memory dcs for the image and the mask
-	dcImage=CreateCompatibleDC(hBackBuffer);
-	dcTrans=CreateCompatibleDC(hBackBuffer);
-
-	// Select the image into the appropriate dc
-	SelectObject(dcImage, mhImage);
+	CFrameBuffer& frameBuffer = mpBackBuffer->getFrameBuffer();
 
-	// Create the mask bitmap
-	BITMAP bitmap;
-	GetObject(mhImage, sizeof(BITMAP), &bitmap);
-	HBITMAP bitmapTrans = CreateBitmap(bitmap.bmWidth, bitmap.bmHeight, 1, 1, NULL);
-
-	// Select the mask bitmap into the appropriate dc
-	SelectObject(dcTrans, bitmapTrans);
-
-	float bltsx = round(bitmap.bmWidth * sx);
-	float bltsy = round(bitmap.bmHeight * sy);
+	// The transparent color mask (and any scaled variant) was built once,
+	// up front, so this is a copy of the opaque runs.
+	if( mpScaled )
+		CBlitter::BlitSpans(frameBuffer, x, y, mpScaled->Image(), mpScaled->Spans(), 0, 0, mpScaled->Width(), mpScaled->Height());
+	else if( mfScaleX == 1.0f && mfScaleY == 1.0f )
+		CBlitter::BlitSpans(frameBuffer, x, y, mpImage->Image(), mpImage->Spans(), 0, 0, w, h);
+	else
+		CBlitter::BlitStretched(frameBuffer, x, y, (int)round(w * mfScaleX), (int)round(h * mfScaleY), mpImage->Image(), 0, 0, w, h,
+								BLIT_COLORKEY, mnTransparentColor);
+}
 
-	// Build mask based on transparent color
-	SetBkColor(dcImage, mcTransparentColor);
-	BitBlt(dcTrans, 0, 0, bitmap.bmWidth, bitmap.bmHeight, dcImage, 0, 0, SRCCOPY);
+bool Sprite::measureDraws(const char *szImageFile, uint32_t nTransparentColor, float fScale, int iCount,
+						  double &fStretched, double &fCached)
+{
+	fStretched = fCached = 0.0;
+
+	Sprite sprite(szImageFile, nTransparentColor);
+	sprite.setScale(fScale, fScale);
+
+	const CSpriteAsset* pDrawn = sprite.drawnImage();
+	if( pDrawn == NULL || iCount <= 0 )
+		return false;
+
+	const int ROUNDS = 20;
+	CFrameBuffer frame(800, 600);
+	int w = sprite.width();
+	int h = sprite.height();
+	int dw = (int)round(w * fScale);
+	int dh = (int)round(h * fScale);
+
+	std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+	for( int n = 0; n < ROUNDS; n++ )
+		for( int i = 0; i < iCount; i++ )
+			CBlitter::BlitStretched(frame, (i * 97) % 800 - dw / 2, (i * 61) % 600 - dh / 2, dw, dh,
+									sprite.mpImage->Image(), 0, 0, w, h, BLIT_COLORKEY, nTransparentColor);
+
+	std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+	for( int n = 0; n < ROUNDS; n++ )
+		for( int i = 0; i < iCount; i++ )
+			CBlitter::BlitSpans(frame, (i * 97) % 800 - dw / 2, (i * 61) % 600 - dh / 2,
+								pDrawn->Image(), pDrawn->Spans(), 0, 0, pDrawn->Width(), pDrawn->Height());
+
+	std::chrono::high_resolution_clock::time_point t2 = std::chrono::high_resolution_clock::now();
+
+	double stretched = std::chrono::duration<double>(t1 - t0).count();
+	double cached = std::chrono::duration<double>(t2 - t1).count();
+	if( stretched > 0.0 ) fStretched = (double)iCount * ROUNDS / stretched;
+	if( cached > 0.0 ) fCached = (double)iCount * ROUNDS / cached;
+	return true;
+}
 
-	// Do the work - True Mask method - cool if not actual display
-	StretchBlt(hBackBuffer, x, y, bltsx, bltsy, dcImage, 0, 0, bitmap.bmWidth, bitmap.bmHeight, SRCINVERT);
-	StretchBlt(hBackBuffer, x, y, bltsx, bltsy, dcTrans, 0, 0, bitmap.bmWidth, bitmap.bmHeight, SRCAND);
-	StretchBlt(hBackBuffer, x, y, bltsx, bltsy, dcImage, 0, 0, bitmap.bmWidth, bitmap.bmHeight, SRCINVERT);
+void Sprite::draw(CDrawList& drawList, EDrawLayer eLayer)
+{
+	if( mpImage == NULL )
+		return;
 
-	// free memory	
-	DeleteDC(dcImage);
-	DeleteDC(dcTrans);
-	DeleteObject(bitmapTrans);
+	// Same upper-left corner as drawMask / drawTransparent.
+	int x = (int)mPosition.x - (width() / 2);
+	int y = (int)mPosition.y - (height() / 2);
 
-	// Restore settings
-	SetBkColor(hBackBuffer, crOldBack);
-	SetTextColor(hBackBuffer, crOldText);
+	if( mpMask != NULL )
+		drawList.Add(eLayer, mpImage, x, y, 1.0f, 1.0f, -1, mId);
+	else if( mpScaled )
+		drawList.Add(eLayer, mpScaled, x, y, 1.0f, 1.0f, -1, mId);
+	else
+		drawList.Add(eLayer, mpImage, x, y, mfScaleX, mfScaleY, -1, mId);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 
-AnimatedSprite::AnimatedSprite(const char *szImageFile, const char *szMaskFile, const RECT& rcFirstFrame, int iFrameCount) 
+AnimatedSprite::AnimatedSprite(const char *szImageFile, const char *szMaskFile, const SAtlasRect& rcFirstFrame, int iFrameCount) 
 			: Sprite (szImageFile, szMaskFile)
 {
-	mptFrameCrop.x = rcFirstFrame.left;
-	mptFrameCrop.y = rcFirstFrame.top;
-	mptFrameStartCrop = mptFrameCrop;
-	miFrameWidth = rcFirstFrame.right - rcFirstFrame.left;
-	miFrameHeight = rcFirstFrame.bottom - rcFirstFrame.top;
+	miFrameWidth = rcFirstFrame.w;
+	miFrameHeight = rcFirstFrame.h;
 	miFrameCount = iFrameCount;
+	miFrame = 0;
+
+	// The sheet is 4 frames wide. Cut it into named frames once; they are
+	// part of the asset, so they move with it into the texture atlas.
+	if( mpImage ) mpImage->DefineFrameGrid(rcFirstFrame.x, rcFirstFrame.y, miFrameWidth, miFrameHeight, iFrameCount, 4);
 }
 
 void AnimatedSprite::SetFrame(int iIndex)
@@ -220,47 +257,50 @@ void AnimatedSprite::SetFrame(int iIndex)
 	// index must be in range
 	assert(iIndex >= 0 && iIndex < miFrameCount && "AnimatedSprite frame Index must be in range!");
 
-	mptFrameCrop.x = mptFrameStartCrop.x + iIndex%4*miFrameWidth;
-	mptFrameCrop.y = mptFrameStartCrop.y + iIndex/4*miFrameHeight;
+	miFrame = iIndex;
+}
+
+bool AnimatedSprite::SetFrame(const char *szName)
+{
+	int iIndex = mpImage ? mpImage->FindFrame(szName) : -1;
+	if( iIndex < 0 )
+		return false;
+
+	miFrame = iIndex;
+	return true;
 }
 
 void AnimatedSprite::draw()
 {
-	if( mpBackBuffer == NULL )
+	if( mpBackBuffer == NULL || mpImage == NULL )
 		return;
 
+	const SAtlasRect& rcFrame = mpImage->GetFrame(miFrame).rc;
+
 	// The position BitBlt wants is not the sprite's center
 	// position; rather, it wants the upper-left position,
 	// so compute that.
-	int fW = miFrameWidth;
-	int fH = miFrameHeight;
-
-	HDC hBackBufferDC = mpBackBuffer->getDC();
+	int fW = rcFrame.w;
+	int fH = rcFrame.h;
 
 	// Upper-left corner.
 	int x = (int)mPosition.x - (fW / 2);
 	int y = (int)mPosition.y - (fH / 2);
 
-	// Note: For this masking technique to work, it is assumed
-	// the backbuffer bitmap has been cleared to some
-	// non-zero value.
-	// Select the mask bitmap.
-	HGDIOBJ oldObj = SelectObject(mhSpriteDC, mhMask);
-
-	// Draw the mask to the backbuffer with SRCAND. This
-	// only draws the black pixels in the mask to the backbuffer,
-	// thereby marking the pixels we want to draw the sprite
-	// image onto.
-	BitBlt(hBackBufferDC, x, y, fW, fH, mhSpriteDC, mptFrameCrop.x, mptFrameCrop.y, SRCAND);
-
-	// Now select the image bitmap.
-	SelectObject(mhSpriteDC, mhImage);
-
-	// Draw the image to the backbuffer with SRCPAINT. This
-	// will only draw the image onto the pixels that where previously
-	// marked black by the mask.
-	BitBlt(hBackBufferDC, x, y, fW, fH, mhSpriteDC, mptFrameCrop.x, mptFrameCrop.y, SRCPAINT);
-
-	// Restore the original bitmap object.
-	SelectObject(mhSpriteDC, oldObj);
-}
\ No newline at end of file
+	// Copy the opaque runs that fall inside the current frame.
+	CBlitter::BlitSpans(mpBackBuffer->getFrameBuffer(), x, y, mpImage->Image(), mpImage->Spans(), rcFrame.x, rcFrame.y, fW, fH);
+}
+
+void AnimatedSprite::draw(CDrawList& drawList, EDrawLayer eLayer)
+{
+	if( mpImage == NULL )
+		return;
+
+	const SAtlasRect& rcFrame = mpImage->GetFrame(miFrame).rc;
+
+	// Upper-left corner.
+	int x = (int)mPosition.x - (rcFrame.w / 2);
+	int y = (int)mPosition.y - (rcFrame.h / 2);
+
+	drawList.Add(eLayer, mpImage, x, y, 1.0f, 1.0f, miFrame, mId);
+}
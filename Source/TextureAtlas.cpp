@@ -0,0 +1,352 @@
+//-----------------------------------------------------------------------------
+// File: TextureAtlas.cpp
+//
+// Desc: Skyline rectangle packer and the texture atlas built on top of it.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTextureAtlas Specific Includes
+//-----------------------------------------------------------------------------
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+
+//-----------------------------------------------------------------------------
+// CSkylinePacker Member Functions
+//-----------------------------------------------------------------------------
+void CSkylinePacker::Init(int width, int height)
+{
+	m_iWidth		= width;
+	m_iHeight		= height;
+	m_iUsedWidth	= 0;
+	m_iUsedHeight	= 0;
+	m_nUsedArea		= 0;
+
+	SSkylineNode node = { 0, 0, width };
+	m_Skyline.clear();
+	m_Skyline.push_back(node);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Fit () (Private)
+// Desc : Returns the y a w x h rectangle would rest at when its left edge is
+//		on skyline node index, or -1 if it does not fit there.
+//-----------------------------------------------------------------------------
+int CSkylinePacker::Fit(size_t index, int w, int h) const
+{
+	int x = m_Skyline[index].x;
+	if (x + w > m_iWidth)
+		return -1;
+
+	int y = 0;
+	int widthLeft = w;
+	for (size_t i = index; widthLeft > 0; i++)
+	{
+		y = std::max(y, m_Skyline[i].y);
+		if (y + h > m_iHeight)
+			return -1;
+		widthLeft -= m_Skyline[i].w;
+	}
+
+	return y;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Insert ()
+// Desc : Places a rectangle where its top edge is lowest (ties go to the
+//		narrowest node) and raises the skyline under it.
+//-----------------------------------------------------------------------------
+bool CSkylinePacker::Insert(int w, int h, int& x, int& y)
+{
+	size_t bestIndex = (size_t)-1;
+	int bestTop = 0, bestWidth = 0;
+
+	for (size_t i = 0; i < m_Skyline.size(); i++)
+	{
+		int fitY = Fit(i, w, h);
+		if (fitY < 0)
+			continue;
+
+		if (bestIndex == (size_t)-1 || fitY + h < bestTop || (fitY + h == bestTop && m_Skyline[i].w < bestWidth))
+		{
+			bestIndex	= i;
+			bestTop		= fitY + h;
+			bestWidth	= m_Skyline[i].w;
+			y			= fitY;
+		}
+	}
+
+	if (bestIndex == (size_t)-1)
+		return false;
+
+	x = m_Skyline[bestIndex].x;
+
+	SSkylineNode node = { x, y + h, w };
+	m_Skyline.insert(m_Skyline.begin() + bestIndex, node);
+
+	// Cut the nodes the new one now covers
+	for (size_t i = bestIndex + 1; i < m_Skyline.size(); )
+	{
+		const SSkylineNode& prev = m_Skyline[i - 1];
+		int overlap = prev.x + prev.w - m_Skyline[i].x;
+		if (overlap <= 0)
+			break;
+
+		m_Skyline[i].x += overlap;
+		m_Skyline[i].w -= overlap;
+		if (m_Skyline[i].w > 0)
+			break;
+
+		m_Skyline.erase(m_Skyline.begin() + i);
+	}
+
+	// Merge neighbours of the same height
+	for (size_t i = 0; i + 1 < m_Skyline.size(); )
+	{
+		if (m_Skyline[i].y == m_Skyline[i + 1].y)
+		{
+			m_Skyline[i].w += m_Skyline[i + 1].w;
+			m_Skyline.erase(m_Skyline.begin() + i + 1);
+		}
+		else
+			i++;
+	}
+
+	m_iUsedWidth	= std::max(m_iUsedWidth, x + w);
+	m_iUsedHeight	= std::max(m_iUsedHeight, y + h);
+	m_nUsedArea	   += (size_t)w * h;
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// CTextureAtlas Member Functions
+//-----------------------------------------------------------------------------
+CTextureAtlas::CTextureAtlas()
+{
+	m_nImageArea = 0;
+}
+
+CTextureAtlas::~CTextureAtlas()
+{
+	Clear();
+}
+
+void CTextureAtlas::AddImage(const std::string& strName, const CFrameBuffer* pImage)
+{
+	SPendingImage image = { strName, pImage };
+	m_PendingImages.push_back(image);
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddSubRect ()
+// Desc : Names a rectangle inside a queued image (an animation frame). It is
+//		moved along with the image when the atlas is packed.
+//-----------------------------------------------------------------------------
+void CTextureAtlas::AddSubRect(const std::string& strName, const std::string& strImage, const SAtlasRect& rc)
+{
+	SPendingRect rect = { strName, strImage, rc };
+	m_PendingRects.push_back(rect);
+}
+
+//-----------------------------------------------------------------------------
+// Name : Pack ()
+// Desc : Places the queued images, tallest first, on pageSize wide pages,
+//		opening a new page when nothing fits. Images bigger than a page get
+//		one to themselves. Pages are then trimmed to what was used, allocated
+//		and filled.
+//-----------------------------------------------------------------------------
+bool CTextureAtlas::Pack(int pageSize)
+{
+	struct SPlacement
+	{
+		size_t	image;
+		int		page, x, y;
+	};
+
+	struct SSortByHeight
+	{
+		const std::vector<SPendingImage>* pImages;
+		bool operator()(size_t a, size_t b) const
+		{
+			const CFrameBuffer* pA = (*pImages)[a].pImage;
+			const CFrameBuffer* pB = (*pImages)[b].pImage;
+			if (pA->Height() != pB->Height()) return pA->Height() > pB->Height();
+			if (pA->Width() != pB->Width())	  return pA->Width() > pB->Width();
+			return (*pImages)[a].strName < (*pImages)[b].strName;
+		}
+	};
+
+	Clear();
+
+	std::vector<size_t> order;
+	for (size_t i = 0; i < m_PendingImages.size(); i++)
+		if (m_PendingImages[i].pImage && m_PendingImages[i].pImage->IsValid())
+			order.push_back(i);
+
+	SSortByHeight sortByHeight = { &m_PendingImages };
+	std::sort(order.begin(), order.end(), sortByHeight);
+
+	std::vector<CSkylinePacker> packers;
+	std::vector<SPlacement> placements;
+
+	for (size_t n = 0; n < order.size(); n++)
+	{
+		const CFrameBuffer* pImage = m_PendingImages[order[n]].pImage;
+		int w = pImage->Width(), h = pImage->Height();
+
+		SPlacement placement = { order[n], -1, 0, 0 };
+
+		if (w <= pageSize && h <= pageSize)
+		{
+			for (size_t p = 0; p < packers.size() && placement.page < 0; p++)
+				if (packers[p].Insert(w, h, placement.x, placement.y))
+					placement.page = (int)p;
+		}
+
+		if (placement.page < 0)
+		{
+			packers.push_back(CSkylinePacker());
+			packers.back().Init(std::max(w, pageSize), std::max(h, pageSize));
+			packers.back().Insert(w, h, placement.x, placement.y);
+			placement.page = (int)packers.size() - 1;
+		}
+
+		placements.push_back(placement);
+	}
+
+	// One allocation per page, only as large as the packed area
+	for (size_t p = 0; p < packers.size(); p++)
+	{
+		CFrameBuffer* pPage = new CFrameBuffer;
+		m_Pages.push_back(pPage);
+		if (!pPage->Create(packers[p].GetUsedWidth(), packers[p].GetUsedHeight()))
+		{
+			Clear();
+			return false;
+		}
+		pPage->Clear(0);
+	}
+
+	for (size_t n = 0; n < placements.size(); n++)
+	{
+		const SPlacement& placement = placements[n];
+		const SPendingImage& image = m_PendingImages[placement.image];
+		CFrameBuffer& page = *m_Pages[placement.page];
+
+		int w = image.pImage->Width(), h = image.pImage->Height();
+		for (int y = 0; y < h; y++)
+			memcpy(page.Row(placement.y + y) + placement.x, image.pImage->Row(y), w * sizeof(uint32_t));
+
+		SAtlasEntry entry;
+		entry.strName	= image.strName;
+		entry.iPage		= placement.page;
+		entry.rc.x		= placement.x;
+		entry.rc.y		= placement.y;
+		entry.rc.w		= w;
+		entry.rc.h		= h;
+
+		m_Index[entry.strName] = m_Entries.size();
+		m_Entries.push_back(entry);
+		m_nImageArea += (size_t)w * h;
+	}
+
+	// Named sub-rectangles follow their image
+	for (size_t n = 0; n < m_PendingRects.size(); n++)
+	{
+		const SPendingRect& rect = m_PendingRects[n];
+		const SAtlasEntry* pImage = Find(rect.strImage);
+		if (!pImage)
+			continue;
+
+		SAtlasEntry entry;
+		entry.strName	= rect.strName;
+		entry.iPage		= pImage->iPage;
+		entry.rc.x		= pImage->rc.x + rect.rc.x;
+		entry.rc.y		= pImage->rc.y + rect.rc.y;
+		entry.rc.w		= rect.rc.w;
+		entry.rc.h		= rect.rc.h;
+
+		m_Index[entry.strName] = m_Entries.size();
+		m_Entries.push_back(entry);
+	}
+
+	m_PendingImages.clear();
+	m_PendingRects.clear();
+	return true;
+}
+
+void CTextureAtlas::Clear()
+{
+	for (size_t i = 0; i < m_Pages.size(); i++)
+		delete m_Pages[i];
+
+	m_Pages.clear();
+	m_Entries.clear();
+	m_Index.clear();
+	m_nImageArea = 0;
+}
+
+void CTextureAtlas::Swap(CTextureAtlas& other)
+{
+	m_PendingImages.swap(other.m_PendingImages);
+	m_PendingRects.swap(other.m_PendingRects);
+	m_Pages.swap(other.m_Pages);
+	m_Entries.swap(other.m_Entries);
+	m_Index.swap(other.m_Index);
+	std::swap(m_nImageArea, other.m_nImageArea);
+}
+
+const SAtlasEntry* CTextureAtlas::Find(const std::string& strName) const
+{
+	std::map<std::string, size_t>::const_iterator it = m_Index.find(strName);
+	return it != m_Index.end() ? &m_Entries[it->second] : NULL;
+}
+
+float CTextureAtlas::GetOccupancy() const
+{
+	size_t pageArea = 0;
+	for (size_t i = 0; i < m_Pages.size(); i++)
+		pageArea += (size_t)m_Pages[i]->Width() * m_Pages[i]->Height();
+
+	return pageArea ? (float)m_nImageArea / (float)pageArea : 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : FormatRectTable ()
+// Desc : The rect table as text: a line per page, then one per entry.
+//-----------------------------------------------------------------------------
+std::string CTextureAtlas::FormatRectTable() const
+{
+	char szLine[512];
+	std::string strTable;
+
+	for (size_t i = 0; i < m_Pages.size(); i++)
+	{
+		snprintf(szLine, sizeof(szLine), "page %u %d %d\n", (unsigned)i, m_Pages[i]->Width(), m_Pages[i]->Height());
+		strTable += szLine;
+	}
+
+	for (size_t i = 0; i < m_Entries.size(); i++)
+	{
+		const SAtlasEntry& entry = m_Entries[i];
+		snprintf(szLine, sizeof(szLine), "%s %d %d %d %d %d\n", entry.strName.c_str(), entry.iPage,
+				 entry.rc.x, entry.rc.y, entry.rc.w, entry.rc.h);
+		strTable += szLine;
+	}
+
+	return strTable;
+}
+
+bool CTextureAtlas::SaveRectTable(const char* szFileName) const
+{
+	FILE* pFile = fopen(szFileName, "w");
+	if (!pFile)
+		return false;
+
+	std::string strTable = FormatRectTable();
+	bool bResult = fwrite(strTable.data(), 1, strTable.size(), pFile) == strTable.size();
+	fclose(pFile);
+	return bResult;
+}
@@ -10,7 +10,7 @@
 // Vec2 Specific Includes
 //-----------------------------------------------------------------------------
 #include "Vec2.h"
-#include "main.h"
+#include "Common.h"
 
 Vec2& Vec2::operator-()
 {
@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// File: WorkerPool.cpp
+//
+// Desc: Small pool of worker threads that run an indexed job in parallel.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CWorkerPool Specific Includes
+//-----------------------------------------------------------------------------
+#include "WorkerPool.h"
+
+//-----------------------------------------------------------------------------
+// CWorkerPool Member Functions
+//-----------------------------------------------------------------------------
+CWorkerPool::CWorkerPool()
+{
+	m_pJob			= NULL;
+	m_nCount		= 0;
+	m_nNext			= 0;
+	m_nGeneration	= 0;
+	m_nBusy			= 0;
+	m_bQuit			= false;
+}
+
+CWorkerPool::~CWorkerPool()
+{
+	Stop();
+}
+
+void CWorkerPool::Start(int nThreads)
+{
+	Stop();
+
+	if (nThreads <= 0)
+		nThreads = (int)std::thread::hardware_concurrency();
+
+	m_bQuit = false;
+	for (int i = 1; i < nThreads; i++)
+		m_Workers.push_back(std::thread(&CWorkerPool::WorkerMain, this, m_nGeneration));
+}
+
+void CWorkerPool::Stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_bQuit = true;
+	}
+	m_WorkReady.notify_all();
+
+	for (size_t i = 0; i < m_Workers.size(); i++)
+		m_Workers[i].join();
+
+	m_Workers.clear();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Run ()
+// Desc : Wakes the workers, helps with the job and waits for the last of
+//		them to leave it, so job can live on the caller's stack.
+//-----------------------------------------------------------------------------
+void CWorkerPool::Run(int count, const std::function<void(int)>& job)
+{
+	if (count <= 0)
+		return;
+
+	if (m_Workers.empty() || count == 1)
+	{
+		for (int i = 0; i < count; i++)
+			job(i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_pJob		= &job;
+		m_nCount	= count;
+		m_nNext		= 0;
+		m_nBusy		= (int)m_Workers.size();
+		m_nGeneration++;
+	}
+	m_WorkReady.notify_all();
+
+	Work();
+
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_WorkDone.wait(lock, [this] { return m_nBusy == 0; });
+	m_pJob = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Work () (Private)
+// Desc : Takes indices until none are left.
+//-----------------------------------------------------------------------------
+void CWorkerPool::Work()
+{
+	for (int i = m_nNext++; i < m_nCount; i = m_nNext++)
+		(*m_pJob)(i);
+}
+
+//-----------------------------------------------------------------------------
+// Name : WorkerMain () (Private)
+// Desc : Sleeps until Run() bumps the generation past the one seen last.
+//-----------------------------------------------------------------------------
+void CWorkerPool::WorkerMain(unsigned int generation)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	for (;;)
+	{
+		m_WorkReady.wait(lock, [&] { return m_bQuit || m_nGeneration != generation; });
+		if (m_bQuit)
+			return;
+
+		generation = m_nGeneration;
+
+		lock.unlock();
+		Work();
+		lock.lock();
+
+		if (--m_nBusy == 0)
+			m_WorkDone.notify_one();
+	}
+}
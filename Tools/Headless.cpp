@@ -0,0 +1,218 @@
+//-----------------------------------------------------------------------------
+// File: Headless.cpp
+//
+// Desc: Command line entry point for the platform independent part of the
+//	   game, built without Win32 by CMakeLists.txt. Runs the checks the
+//	   game only asserts in its Windows debug build, steps the world with
+//	   scripted input as fast as it goes, plays recorded logs back and
+//	   runs the simulation's benchmarks.
+//
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// Headless Specific Includes
+//-----------------------------------------------------------------------------
+#include "Blitter.h"
+#include "AabbBatch.h"
+#include "GameWorld.h"
+#include "Replay.h"
+#include "Random.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const int		HEADLESS_FIELD_WIDTH	= 800;		// Play field of the scripted runs
+const int		HEADLESS_FIELD_HEIGHT	= 600;
+
+//-----------------------------------------------------------------------------
+// Name : RunVerify () (Static)
+// Desc : Every SIMD kernel this CPU runs against the scalar reference.
+//		Returns the number of checks that failed.
+//-----------------------------------------------------------------------------
+static int RunVerify()
+{
+	int nFailed = 0;
+
+	bool bBlit = CBlitter::Verify();
+	printf("Blit kernels up to %s: %s\n", CBlitter::GetKernels(CBlitter::GetMaxLevel()).szName, bBlit ? "identical" : "DIFFER");
+	if (!bBlit) nFailed++;
+
+	bool bBoxes = CAabbBatch::Verify();
+	printf("Box overlap and sweep kernels up to %s: %s\n", CBlitter::GetKernels(CAabbBatch::GetLevel()).szName, bBoxes ? "identical" : "DIFFER");
+	if (!bBoxes) nFailed++;
+
+	return nFailed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunSteps () (Static)
+// Desc : Steps a world from nSeed up to nSteps times, or until the game is
+//		over, holding a random direction for a second at a time and firing
+//		four times a second. The input is drawn from its own stream, so the
+//		same seed plays the same game. Records the run when szRecordFile is
+//		given.
+//-----------------------------------------------------------------------------
+static int RunSteps(unsigned long nSteps, uint64_t nSeed, const char* szRecordFile)
+{
+	CGameWorld world;
+	if (!world.Init(nSeed))
+	{
+		fprintf(stderr, "Failed to load the game data.\n");
+		return 1;
+	}
+
+	CReplayWriter recorder;
+	if (szRecordFile && !recorder.Open(szRecordFile, world))
+	{
+		fprintf(stderr, "Failed to create %s.\n", szRecordFile);
+		return 1;
+	}
+
+	CRandom random(nSeed, RANDOM_STREAM_COUNT);
+	SGameInput input = { 0, 0, HEADLESS_FIELD_WIDTH, HEADLESS_FIELD_HEIGHT };
+	unsigned long nStep = 0;
+
+	std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+	for (; nStep < nSteps && !world.IsGameOver(); nStep++)
+	{
+		if (nStep % 240 == 0)
+			input.nDirection = random.NextBelow(16);
+		input.nFire = nStep % 60 == 0 ? 1 : 0;
+
+		world.Step(input);
+		recorder.Write(input, world);
+	}
+	double fSeconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+	recorder.Close();
+
+	printf("%lu steps in %.3f s, %.0f steps/s, score %d, level %d%s\n", nStep, fSeconds, fSeconds > 0.0 ? nStep / fSeconds : 0.0,
+		   world.GetScore(), world.GetLevel(), world.IsGameOver() ? ", game over" : "");
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunReplay () (Static)
+// Desc : The headless CGameApp::RunReplay(): exits with 2 when the world
+//		stopped matching the recording.
+//-----------------------------------------------------------------------------
+static int RunReplay(const char* szFileName)
+{
+	CReplayReader reader;
+	SReplayResult result;
+	if (!reader.Open(szFileName) || !reader.Play(result))
+	{
+		fprintf(stderr, "Failed to load the replay or the game data.\n");
+		return 1;
+	}
+
+	double fRate = result.fSeconds > 0.0 ? result.nSteps / result.fSeconds : 0.0;
+	if (result.nDivergedStep)
+	{
+		printf("DIVERGED after step %lu, by step %lu (state hashes every %u steps).\n%lu steps in %.3f s, %.0f steps/s.\n",
+			   result.nLastMatchStep, result.nDivergedStep, reader.GetHeader().nHashInterval, result.nSteps, result.fSeconds, fRate);
+		return 2;
+	}
+
+	printf("Identical: %lu steps, %lu state hashes matched, score %d%s.\n%.3f s, %.0f steps/s.\n",
+		   result.nSteps, result.nHashes, result.iScore, result.bGameOver ? ", game over" : "", result.fSeconds, fRate);
+
+	double msMean, msMax;
+	if (reader.MeasureSeek(16, msMean, msMax))
+		printf("Seek: %.2f ms mean, %.2f ms worst over 16 steps (%u keyframes, every %u steps).\n",
+			   msMean, msMax, (unsigned)reader.GetKeyframeCount(), reader.GetHeader().nKeyframeInterval);
+	return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunBench () (Static)
+// Desc : The benchmarks of the game's debug keys 'U' and 'G', with the same
+//		sizes. Exits with 1 when the two ways measured disagree.
+//-----------------------------------------------------------------------------
+static int RunBench(const char* szName)
+{
+	if (strcmp(szName, "bullets") == 0)
+	{
+		double msObjects = 0.0, msArrays = 0.0;
+		bool bMatch = CGameWorld::MeasureBulletUpdate(100000, 100, msObjects, msArrays);
+		printf("Bullet update, 100000 bullets: objects %.3f ms, arrays %.3f ms (x%.1f), %s\n",
+			   msObjects, msArrays, msObjects / msArrays, bMatch ? "identical" : "DIFFERS");
+		return bMatch ? 0 : 1;
+	}
+
+	if (strcmp(szName, "broadphase") == 0)
+	{
+		double msBruteForce = 0.0, msGrid = 0.0;
+		bool bMatch = CGameWorld::MeasureBroadphase(20000, 1000, 10, msBruteForce, msGrid);
+		printf("Broadphase, 20000 bullets x 1000 targets: all pairs %.3f ms, grid %.3f ms (x%.1f), %s\n",
+			   msBruteForce, msGrid, msBruteForce / msGrid, bMatch ? "identical" : "DIFFERS");
+
+		for (int level = BLIT_SCALAR; level < BLIT_LEVEL_COUNT; level++)
+		{
+			double fRate = CAabbBatch::MeasureThroughput((EBlitLevel)level);
+			if (fRate <= 0.0)
+				continue;
+
+			double fSweepRate = CAabbBatch::MeasureSweepThroughput((EBlitLevel)level);
+			printf("  Box kernel %-6s: %.0f boxes/us, swept %.0f boxes/us%s\n", CBlitter::GetKernels((EBlitLevel)level).szName,
+				   fRate, fSweepRate, level == CAabbBatch::GetLevel() ? " (in use)" : "");
+		}
+		return bMatch ? 0 : 1;
+	}
+
+	fprintf(stderr, "Unknown benchmark %s, use bullets or broadphase.\n", szName);
+	return 2;
+}
+
+//-----------------------------------------------------------------------------
+// Name : main () (Application Entry Point)
+// Desc : "-verify" (the default) exits with 1 when a check fails.
+//		"-steps <n> [-seed <s>] [-record <file>]" runs the world headless,
+//		"-replay <file>" plays a log back, "-bench bullets|broadphase"
+//		times the simulation.
+//-----------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	CBlitter::Init();
+	CAabbBatch::Init();
+
+	if (argc < 2 || strcmp(argv[1], "-verify") == 0)
+		return RunVerify() ? 1 : 0;
+
+	if (strcmp(argv[1], "-replay") == 0 && argc == 3)
+		return RunReplay(argv[2]);
+
+	if (strcmp(argv[1], "-bench") == 0 && argc == 3)
+		return RunBench(argv[2]);
+
+	if (strcmp(argv[1], "-steps") == 0 && argc >= 3)
+	{
+		unsigned long nSteps = strtoul(argv[2], NULL, 10);
+		uint64_t nSeed = GAMEWORLD_DEFAULT_SEED;
+		const char* szRecordFile = NULL;
+
+		int i = 3;
+		for (; i + 1 < argc; i += 2)
+		{
+			if (strcmp(argv[i], "-seed") == 0)
+				nSeed = strtoull(argv[i + 1], NULL, 10);
+			else if (strcmp(argv[i], "-record") == 0)
+				szRecordFile = argv[i + 1];
+			else
+				break;
+		}
+
+		if (i == argc)
+			return RunSteps(nSteps, nSeed, szRecordFile);
+	}
+
+	fprintf(stderr, "usage: %s [-verify]\n"
+					"       %s -steps <n> [-seed <s>] [-record <file>]\n"
+					"       %s -replay <file>\n"
+					"       %s -bench bullets|broadphase\n", argv[0], argv[0], argv[0], argv[0]);
+	return 2;
+}